@@ -5,6 +5,13 @@
 #include "freertos/task.h"
 #include "AudioKitHAL.h"
 #include <WiFi.h>
+#include "../dsp/fir.h"
+#include "../dsp/fir_q15.h"
+#include "../dsp/multichannel.h"
+#include "../dsp/iir.h"
+#include "../dsp/iir_design.h"
+#include "../dsp/iir_simd.h"
+#include "../dsp/param_slot.h"
 
 /* Private Defines ---------------------------*/
 #define DMA_BUFFER_SIZE 32
@@ -21,6 +28,15 @@
 #define GPIO_LOW    0
 #define GPIO_HIGH   1
 
+#define SAMPLE_RATE       48000.0F
+#define TUNE_NUM_SECTIONS 2     // Order 4 LP/HP, order 2 BP/BS: always 2 biquads
+#define TUNE_FC_MIN       100.0F
+#define TUNE_FC_MAX       12000.0F
+#define TUNE_FC_STEP      1.259921F   // 1/3 octave per key press
+#define TUNE_GAIN_STEP_DB 3.0F
+#define KEY_POLL_MS       20    // Key task period (also the debounce time)
+#define FIR_MONO_Q15      0     // 1: Left channel only in Q15, written to both channels, instead of the stereo float FIR
+
 /* Private Macros ------------------------*/
 #define TOFLOAT(X)  ((float)(X)/32767.0F)
 #define TOINT16(X)  ((X)*32767.0F)
@@ -28,39 +44,47 @@
 #define MIN(X,Y)    ((X) < (Y) ? (X) : (Y))
 
 /* Private Structures ------------------------*/
+// Parameter set handed from the key task to the audio loop (plain data, no heap)
+struct TuneParams_t
+{
+  dsp::Biquad sos[TUNE_NUM_SECTIONS];   //!< Sections with the gain folded into the last one
+};
+
+// State of the key task, only touched by that task
+struct TuneControl_t
+{
+  dsp::IirType type;
+  float fc;       //!< Cutoff or band center in Hz
+  float gainDb;
+  bool bypass;
+};
 
 /* Private Constants ------------------------*/
 //const size_t IIR_ORDER = 2;
 //const float iir_b_coefs[IIR_ORDER] = {1.1, 0.5};
 //const float iir_a_coefs[IIR_ORDER-1] = {0.3};
-const float fir_filt_coefs[11] = {0.01131245456295710584,	0.02660055636482243011,	0.06864020619336545781,	0.12482787853108187615,	0.17280429834737529027,	0.19162921200079557904,	0.17280429834737529027,	0.12482787853108187615,	0.06864020619336545781,	0.02660055636482243011,	0.01131245456295710584,	>> };
-float xprev[10];
-
-float calc_fir_filter(float x)
-{
-  // Compute convolution
-  float y = x*fir_filt_coefs[0];  // y[n] = x[n]*h[0] + x[n-1]*h[1] + ...
-  for(int i=0; i < 10; i++)
-  {
-    y += xprev[i]*fir_filt_coefs[i+1];
-  }
+const float fir_filt_coefs[11] = {0.01131245456295710584,	0.02660055636482243011,	0.06864020619336545781,	0.12482787853108187615,	0.17280429834737529027,	0.19162921200079557904,	0.17280429834737529027,	0.12482787853108187615,	0.06864020619336545781,	0.02660055636482243011,	0.01131245456295710584};
 
-  // Update the previous samples
-  for(int i = 9; i>0; i--)
-  {
-    xprev[i] = xprev[i-1];
-  }
-  xprev[0] = x;
-
-  return y;
-}
 /* Private Variables -------------------------*/
 int16_t AudioBuffer[DMA_BUFFER_SIZE];	//!< Buffer that stores the data to process
 AudioKit kit;
-//IIRFilter f1(IIR_ORDER, iir_a_coefs, iir_b_coefs);
+//dsp::FirFilter fir(fir_filt_coefs, 11, dsp::FIR_SYMMETRIC);	//!< Float folded linear-phase FIR
+#if FIR_MONO_Q15
+int16_t fir_coefs_q15[11];	//!< fir_filt_coefs quantized to Q15
+int16_t fir_state_q15[2*11];	//!< Mirrored delay line of the Q15 FIR
+FirQ15_t fir;	//!< Fixed-point FIR (Left channel only), filters the int16 frame without float conversions
+#else
+dsp::MultiChannelFir stereo(fir_filt_coefs, 11, 2, DMA_BUFFER_SIZE/2);	//!< True stereo FIR, independent L/R state, folded, in one pass
+#endif
+dsp::MultiChannelSos tunable;  //!< Stereo IIR retuned from the keys while audio runs
+dsp::ParamSlot<TuneParams_t> tuneSlot;  //!< Key task -> audio loop, lock-free
+TuneControl_t tune = {dsp::IIR_LOWPASS, 2000.0F, 0.0F, false};
+//dsp::SosCascade f1(iir_b_coefs, IIR_ORDER, iir_a_coefs, IIR_ORDER-1);	//!< b0..bN, a1..aN (a0 = 1), factored into biquads
 
 /* Private functions --------------------------*/
 void audiokit_gpio_init(void);
+void tune_design(const TuneControl_t *pTune, TuneParams_t *pParams);
+void key_task(void *pArg);
 
 /* Interrupts ---------------------------------*/
 
@@ -71,6 +95,12 @@ void setup()
   // iir reset
   //f1.reset();
 
+#if FIR_MONO_Q15
+  // Q15 FIR init
+  FIR_Q15_Quantize(fir_filt_coefs, fir_coefs_q15, 11);
+  FIR_Q15_Init(&fir, fir_coefs_q15, fir_state_q15, 11);
+#endif
+
   // I2S Config
   AudioKitConfig cfg = kit.defaultConfig(KitInputOutput);
   cfg.adc_input = AUDIO_HAL_ADC_INPUT_LINE2;	// MICROPHONE/AUXIN audio input
@@ -84,6 +114,17 @@ void setup()
   kit.setSpeakerActive(false);
   // BSP audiokit gpio initialization
   audiokit_gpio_init();
+
+  // Subnormal floats off for the audio task (setup() runs on the loop task).
+  // Silent input is skipped by tunable once its state has decayed.
+  DSP_EnableFlushToZero();
+
+  // Tunable IIR: first design here, later ones come from the key task
+  TuneParams_t params;
+  tune_design(&tune, &params);
+  tunable.init(std::vector<dsp::Biquad>(params.sos, params.sos + TUNE_NUM_SECTIONS), 2, DMA_BUFFER_SIZE/2);
+  // The loop task runs on core 1, keys and filter design go to core 0
+  xTaskCreatePinnedToCore(key_task, "keys", 4096, NULL, 1, NULL, 0);
 }
 
 /* Main loop ----------------------------------*/
@@ -102,25 +143,24 @@ void loop()
 
   // DSP processing goes here
   // "AudioBuffer" variable has both Left and Right audio samples
-  // n+=2 ensures we take only the Left audio samples
-  for(int n = 0; n < bytesRead/2; n+=2)
+#if FIR_MONO_Q15
+  // Mono: the Left samples are filtered in Q15, saturated and written back
+  // to both channels
+  FIR_Q15_ProcessAudioBuffer(&fir, AudioBuffer, bytesRead/2);
+#else
+  // The whole frame is filtered in one call: Left and Right are filtered
+  // with their own delay lines (bytesRead/4 stereo frames)
+  stereo.processInterleaved(AudioBuffer, bytesRead/4);
+#endif
+
+  // Tunable IIR: a new set from the keys is crossfaded in over the next
+  // DSP_SOS_FADE_FRAMES frames (many blocks), fetch() never waits for the
+  // key task
+  if(tuneSlot.fetch())
   {
-    // Get current sample: int16 to float
-    float x_L = TOFLOAT(AudioBuffer[n]);
-	  float x_R = TOFLOAT(AudioBuffer[n+1]);
-	
-    // Process sample by sample
-    // BEGIN
-    float y = calc_fir_filter(x_L);
-    // END
-    
-    // Audio clipping Keeps audio between [-1,1]
-    y = MIN(MAX(y,-1.0F),1.0F);
-  
-    // float to int16
-    AudioBuffer[n] = TOINT16(y);
-    AudioBuffer[n+1] = TOINT16(y);
+    tunable.update(tuneSlot.current().sos, TUNE_NUM_SECTIONS);
   }
+  tunable.processInterleaved(AudioBuffer, bytesRead/4);
   
   // Signal Interpolation
   // Suspend main thread until buffer size is read (yield from interrupt)
@@ -139,6 +179,72 @@ void loop()
 
 
 /* Reference functions -----------------------------------------*/
+// Designs the tunable IIR (runs in the key task: heap and trigonometry are
+// fine there, never in the audio loop)
+void tune_design(const TuneControl_t *pTune, TuneParams_t *pParams)
+{
+  const float toRad = 2.0F*(float)M_PI/SAMPLE_RATE;
+  const bool band = pTune->type == dsp::IIR_BANDPASS || pTune->type == dsp::IIR_BANDSTOP;
+  dsp::IirDesignSpec spec = {pTune->type, dsp::IIR_BUTTERWORTH, band ? 2 : 4, pTune->fc*toRad, 0.0F, 0.0F, true};
+  if(band)
+  {
+    // One octave around fc
+    spec.w1 = pTune->fc*toRad*(float)M_SQRT1_2;
+    spec.w2 = pTune->fc*toRad*(float)M_SQRT2;
+  }
+  std::vector<dsp::Biquad> sos;
+  if(pTune->bypass || !dsp::iirDesign(spec, sos) || sos.size() != TUNE_NUM_SECTIONS)
+  {
+    sos.assign(TUNE_NUM_SECTIONS, dsp::Biquad{1.0F, 0.0F, 0.0F, 0.0F, 0.0F});
+  }
+  const float g = powf(10.0F, pTune->gainDb/20.0F);
+  sos.back().b0 *= g;
+  sos.back().b1 *= g;
+  sos.back().b2 *= g;
+  for(size_t s = 0; s < TUNE_NUM_SECTIONS; s++) pParams->sos[s] = sos[s];
+}
+
+/*
+ * Key task: polls KEY_1..KEY_6 (0 when pressed) every KEY_POLL_MS, acts on
+ * presses and publishes the new sections to the audio loop.
+ *   KEY_1/KEY_2: cutoff down/up 1/3 octave   KEY_3/KEY_4: gain -/+3 dB
+ *   KEY_5: LP -> HP -> BP -> BS               KEY_6: bypass on/off
+ */
+void key_task(void *pArg)
+{
+  const gpio_num_t keys[6] = {KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6};
+  uint8_t last[6] = {GPIO_HIGH, GPIO_HIGH, GPIO_HIGH, GPIO_HIGH, GPIO_HIGH, GPIO_HIGH};
+  (void)pArg;
+
+  for(;;)
+  {
+    vTaskDelay(pdMS_TO_TICKS(KEY_POLL_MS));
+    bool changed = false;
+    for(int k = 0; k < 6; k++)
+    {
+      uint8_t level = (uint8_t)gpio_get_level(keys[k]);
+      bool pressed = (level == GPIO_LOW) && (last[k] == GPIO_HIGH);
+      last[k] = level;
+      if(!pressed) continue;
+      changed = true;
+      switch(k)
+      {
+        case 0: tune.fc = MAX(tune.fc/TUNE_FC_STEP, TUNE_FC_MIN); break;
+        case 1: tune.fc = MIN(tune.fc*TUNE_FC_STEP, TUNE_FC_MAX); break;
+        case 2: tune.gainDb = MAX(tune.gainDb - TUNE_GAIN_STEP_DB, -30.0F); break;
+        case 3: tune.gainDb = MIN(tune.gainDb + TUNE_GAIN_STEP_DB, 12.0F); break;
+        case 4: tune.type = (dsp::IirType)((tune.type + 1) % 4); break;
+        default: tune.bypass = !tune.bypass; break;
+      }
+    }
+    if(!changed) continue;
+
+    tune_design(&tune, &tuneSlot.edit());
+    tuneSlot.publish();
+    gpio_set_level(LED_4, tune.bypass ? GPIO_HIGH : GPIO_LOW);
+  }
+}
+
 void audiokit_gpio_init(void)
 {
   // Set GPIO to reset state
@@ -0,0 +1,226 @@
+/*
+ * asrc.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Asynchronous sample-rate converter between two audio clocks of the same
+ *  nominal rate (lab5: the I2S2 microphone in, the I2S3 DAC out). Plain C,
+ *  static inline, mono int16 out of an SpscRing_t.
+ *  - Fractional delay: windowed sinc, ASRC_TAPS taps in ASRC_PHASES + 1
+ *    phases, two neighbouring phases interpolated linearly (2 * ASRC_TAPS
+ *    MACs per output, 16.5 KB of table). Every phase has a DC gain of
+ *    exactly 1. The window ripple and the phase interpolation both change
+ *    with the phase, which sweeps at the clock offset; they are kept near
+ *    -90 dB up to about 15 kHz.
+ *  - Each output advances the read position by ratio input samples, the
+ *    input rate over the output rate: 1 + delta / 2^32 with the fraction of
+ *    the position in 32 bits, so one output takes 0, 1 or 2 inputs and the
+ *    ratio is exact (a float position would add a rounding bias per step).
+ *  - ASRC_Update(), once per output block: a PI loop on the FIFO level
+ *    steers ratio so that the level stays at the target, i.e. the latency is
+ *    constant and the FIFO never runs empty or full; the integrator ends up
+ *    holding the clock offset. The level should include the input already
+ *    captured but not yet in the FIFO (lab5: the cycle counter since the
+ *    RX half interrupt), otherwise it jumps by a block whenever the input
+ *    blocks drift past the output blocks.
+ *  - Nothing is read before the level first reaches the target (silence is
+ *    output). An empty FIFO after that repeats the last sample and is counted
+ *    in underruns.
+ */
+
+#ifndef DSP_ASRC_H_
+#define DSP_ASRC_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include "spsc_ring.h"
+
+#ifndef M_PI
+#define M_PI	(3.14159265358979323846)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported define ------------------------------------------------------------*/
+#define ASRC_TAPS			(32)	// Even; the output is ASRC_TAPS/2 samples late
+#define ASRC_PHASE_BITS		(7)
+#define ASRC_PHASES			(1 << ASRC_PHASE_BITS)
+#define ASRC_BETA			(9.0)	// Kaiser beta of the sinc window, about 90 dB
+#define ASRC_CUTOFF			(0.475)	// Of the input rate
+#define ASRC_MAX_BLOCK		(64)	// Outputs per ASRC_Process() call
+#define ASRC_MAX_PPM		(1000.0F)	// Largest clock offset followed
+
+/* Exported typedef -----------------------------------------------------------*/
+typedef struct
+{
+	float coef[ASRC_PHASES + 1][ASRC_TAPS];	// [phase][tap], tap 0 the oldest input
+	float hist[ASRC_TAPS + ASRC_MAX_BLOCK + 2];	// Last ASRC_TAPS inputs, then the new ones
+	uint32_t mu;		// Read position between hist[ASRC_TAPS/2-1] and the next, Q0.32
+	uint32_t advance;	// Inputs to take before the next output
+	int32_t delta;		// ratio - 1 in Q0.32
+	float ratio;		// Input samples per output sample (1 + delta / 2^32)
+	float target;		// FIFO level to hold, in input samples
+	float kp, ki;		// PI gains, per sample of level error
+	float integ;		// Integrator: ratio - 1 without level error
+	float error;		// Last level error
+	uint8_t started;
+	uint32_t underruns;	// Outputs made from a repeated sample
+} Asrc_t;
+
+/* Exported function prototypes -----------------------------------------------*/
+static inline double ASRC_BesselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	for(int k = 1; k < 40; k++)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+static inline void ASRC_Reset(Asrc_t *pAsrc)
+{
+	memset(pAsrc->hist, 0, sizeof(pAsrc->hist));
+	pAsrc->mu = 0;
+	pAsrc->advance = 0;
+	pAsrc->delta = 0;
+	pAsrc->ratio = 1.0F;
+	pAsrc->integ = 0.0F;
+	pAsrc->error = 0.0F;
+	pAsrc->started = 0;
+	pAsrc->underruns = 0;
+}
+
+/*
+ * target: FIFO level to hold (input samples), at least a block more than
+ * the level right after a block is read. The loop settles with loopHz of
+ * natural frequency (critically damped, 0.1 Hz: a few seconds) when
+ * ASRC_Update() runs blockRate times per second before blocks of blockLen
+ * outputs. Double math, call once at startup.
+ */
+static inline void ASRC_Init(Asrc_t *pAsrc, float target, float loopHz, uint16_t blockLen, float blockRate)
+{
+	for(int p = 0; p <= ASRC_PHASES; p++)
+	{
+		double sum = 0.0, h[ASRC_TAPS];
+		for(int j = 0; j < ASRC_TAPS; j++)
+		{
+			// Distance of tap j from the read position, in input samples
+			const double d = ASRC_TAPS / 2 - 1 - j + (double)p / ASRC_PHASES;
+			const double t = d / (ASRC_TAPS / 2);
+			const double w = fabs(t) < 1.0 ? ASRC_BesselI0(ASRC_BETA * sqrt(1.0 - t * t)) / ASRC_BesselI0(ASRC_BETA) : 0.0;
+			const double x = 2.0 * ASRC_CUTOFF * d;
+			h[j] = w * (x == 0.0 ? 1.0 : sin(M_PI * x) / (M_PI * x));
+			sum += h[j];
+		}
+		for(int j = 0; j < ASRC_TAPS; j++) pAsrc->coef[p][j] = (float)(h[j] / sum);
+	}
+
+	// Level gains blockLen * (rate offset) per block: a double integrator
+	// with the PI, wn^2 = blockLen * ki, 2 zeta wn = blockLen * kp
+	const double wn = 2.0 * M_PI * loopHz / blockRate;
+	pAsrc->kp = (float)(2.0 * wn / blockLen);
+	pAsrc->ki = (float)(wn * wn / blockLen);
+	pAsrc->target = target;
+	ASRC_Reset(pAsrc);
+}
+
+/*
+ * Once per output block, before ASRC_Process(): level is the FIFO count
+ * (plus the input captured but not in the FIFO yet).
+ */
+static inline void ASRC_Update(Asrc_t *pAsrc, float level)
+{
+	if(!pAsrc->started)
+	{
+		if(level < pAsrc->target) return;
+		pAsrc->started = 1;
+	}
+	// Samples still to be taken for the next output count as read already
+	pAsrc->error = level - (float)pAsrc->advance - (float)pAsrc->mu * 2.3283064e-10F - pAsrc->target;
+	const float lim = ASRC_MAX_PPM * 1e-6F;
+	float integ = pAsrc->integ + pAsrc->ki * pAsrc->error;
+	integ = integ > lim ? lim : (integ < -lim ? -lim : integ);
+	float ofs = integ + pAsrc->kp * pAsrc->error;
+	ofs = ofs > lim ? lim : (ofs < -lim ? -lim : ofs);
+	pAsrc->integ = integ;
+	pAsrc->delta = (int32_t)(ofs * 4294967296.0F);
+	pAsrc->ratio = 1.0F + ofs;
+}
+
+// Inputs the next output takes, moving *pMu on by ratio
+static inline uint32_t ASRC_Step(uint32_t *pMu, int32_t delta)
+{
+	const uint32_t mu = *pMu + (uint32_t)delta;
+	const uint32_t adv = delta >= 0 ? 1U + (mu < *pMu) : 1U - (mu > *pMu);
+	*pMu = mu;
+	return adv;
+}
+
+// numOut (<= ASRC_MAX_BLOCK) mono samples, reading what they need from pRing
+static inline void ASRC_Process(Asrc_t *pAsrc, SpscRing_t *pRing, int16_t *pOut, uint16_t numOut)
+{
+	const int H = ASRC_TAPS;
+	if(!pAsrc->started)
+	{
+		memset(pOut, 0, numOut * sizeof(int16_t));
+		return;
+	}
+
+	// Inputs this block: the pending advance, then one per output but the last
+	uint32_t mu = pAsrc->mu, need = pAsrc->advance, adv = 0;
+	for(uint16_t n = 0; n < numOut; n++)
+	{
+		adv = ASRC_Step(&mu, pAsrc->delta);
+		if(n + 1 < numOut) need += adv;
+	}
+
+	// Read them after the history, converted to float
+	float *x = &pAsrc->hist[H];
+	int16_t in[ASRC_MAX_BLOCK + 2];
+	const uint32_t got = SPSC_ReadBlock(pRing, in, need);
+	for(uint32_t k = 0; k < got; k++) x[k] = (float)in[k];
+	for(uint32_t k = got; k < need; k++) x[k] = x[(int32_t)k - 1];
+	pAsrc->underruns += need - got;
+
+	// Outputs: the window ends ASRC_TAPS/2 samples after the read position,
+	// it moves by the advance of every output
+	const float *w = &pAsrc->hist[pAsrc->advance];
+	mu = pAsrc->mu;
+	for(uint16_t n = 0; n < numOut; n++)
+	{
+		// Phase from the top bits, the rest interpolates to the next phase
+		const uint32_t p = mu >> (32 - ASRC_PHASE_BITS);
+		const float f = (float)(mu & ((1U << (32 - ASRC_PHASE_BITS)) - 1U)) * (1.0F / (float)(1U << (32 - ASRC_PHASE_BITS)));
+		float y0 = 0.0F, y1 = 0.0F;
+		for(int j = 0; j < ASRC_TAPS; j++)
+		{
+			y0 += pAsrc->coef[p][j] * w[j];
+			y1 += pAsrc->coef[p + 1][j] * w[j];
+		}
+		float y = y0 + f * (y1 - y0);
+		y += y >= 0.0F ? 0.5F : -0.5F;
+		pOut[n] = (int16_t)(y > 32767.0F ? 32767 : (y < -32768.0F ? -32768 : (int32_t)y));
+
+		const uint32_t a = ASRC_Step(&mu, pAsrc->delta);
+		if(n + 1 < numOut) w += a;
+	}
+	pAsrc->mu = mu;
+	pAsrc->advance = adv;
+
+	// Keep the last window (the next output may not advance at all)
+	memmove(pAsrc->hist, &pAsrc->hist[need], H * sizeof(float));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_ASRC_H_ */
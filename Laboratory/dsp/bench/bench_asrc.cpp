@@ -0,0 +1,210 @@
+/*
+ * bench_asrc.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark of the lab5 ASRC (asrc.h):
+ *  - fractional delay quality: sines at a fixed ratio, SINAD against a
+ *    least-squares fit at the expected output frequency,
+ *  - lab5 over 10 minutes of uptime: 48-sample blocks in from an RX clock
+ *    off by ppm, 48-sample blocks out at the TX clock, the 512-sample FIFO
+ *    between them. The old FIFO (a TX half skipped when the FIFO runs short,
+ *    RX samples dropped when it is full) against the ASRC with its level
+ *    measured at every TX block as the FIFO count plus the part of the RX
+ *    half already captured, taken from
+ *      - the RX DMA counter: whole PDM words, half a sample at D = 32; the
+ *        drift sweeps that step through the loop (reported only),
+ *      - the cycle counter since the RX half interrupt, as lab5 does, with
+ *        +-0.03 sample of interrupt latency jitter.
+ *    Checks for the latter, after the loop has settled: no underrun, no
+ *    drop, the level (the latency) within a sample of the target, the
+ *    ratio averaged over the settled part within MAX_RATIO_PPM of the clock
+ *    ratio and the 1 kHz tone clean. The last ratio alone would be off by
+ *    the proportional term of the last level error, a constant bias that
+ *    hides the real tracking error,
+ *  - cycles per output sample.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_asrc.cpp -o bench_asrc
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../asrc.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FS				(48000.0)
+#define BLOCK			(48)		// lab5 AUDIO_NUM_OUT_SAMPLES
+#define FIFO_SIZE		(512)		// lab5 AUDIO_PCM_FIFO_SIZE
+#define TARGET			(3 * BLOCK)
+#define LOOP_HZ			(0.1F)
+#define UPTIME_S		(600)
+#define SETTLE_S		(30)
+#define DECIM			(32)		// PDM bits per sample: 16-bit words = half a sample
+#define MAX_RATIO_PPM	(0.01)		// One sample of level drift over the settled 570 s: 0.037 ppm
+
+/* Private function reference -----------------------------------------------*/
+// SINAD of y against a sine of f cycles/sample (least squares; no DC, a sample
+// mean over a fraction of a period would be off by an LSB at 1 kHz)
+static double sinad(const std::vector<int16_t> &y, size_t from, double f)
+{
+	double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+	for(size_t n = from; n < y.size(); n++)
+	{
+		const double s = sin(2.0 * M_PI * f * n), c = cos(2.0 * M_PI * f * n);
+		ss += s * s; sc += s * c; cc += c * c; ys += y[n] * s; yc += y[n] * c;
+	}
+	const double det = ss * cc - sc * sc, a = (ys * cc - yc * sc) / det, b = (yc * ss - ys * sc) / det;
+	double sig = 0.0, err = 0.0;
+	for(size_t n = from; n < y.size(); n++)
+	{
+		const double fit = a * sin(2.0 * M_PI * f * n) + b * cos(2.0 * M_PI * f * n);
+		sig += fit * fit;
+		err += (y[n] - fit) * (y[n] - fit);
+	}
+	return 10.0 * log10(sig / err);
+}
+
+static int quality()
+{
+	printf("fixed ratio, -6 dBFS sine (SINAD):\n");
+	int fails = 0;
+	for(double ratio : {1.0001, 0.9997})
+	{
+		printf("    ratio %.4f:", ratio);
+		for(double f : {1000.0, 8000.0, 15000.0, 19000.0})
+		{
+			static Asrc_t a;
+			ASRC_Init(&a, 0.0F, LOOP_HZ, BLOCK, 1000.0F);
+			a.started = 1;
+			a.delta = (int32_t)lrint((ratio - 1.0) * 4294967296.0);
+			std::vector<int16_t> mem(4096), in(BLOCK * 2), y(BLOCK * 2000);
+			SpscRing_t ring;
+			SPSC_Init(&ring, mem.data(), 4096);
+			size_t n = 0;
+			for(size_t b = 0; b < y.size() / BLOCK; b++)
+			{
+				while(SPSC_Space(&ring) >= in.size())
+				{
+					for(int16_t &v : in) v = (int16_t)lrint(16384.0 * sin(2.0 * M_PI * f / FS * (double)n++));
+					SPSC_WriteBlock(&ring, in.data(), (uint32_t)in.size());
+				}
+				ASRC_Process(&a, &ring, &y[b * BLOCK], BLOCK);
+			}
+			const double s = sinad(y, y.size() / 4, f / FS * (1.0 + a.delta / 4294967296.0));
+			// int16 rounding alone is about 92 dB at -6 dBFS
+			const bool ok = s > 85.0;
+			fails += !ok;
+			printf(" %5.0f Hz %5.1f dB%s", f, s, ok ? "" : " FAIL");
+		}
+		printf("\n");
+	}
+	return fails;
+}
+
+enum { OLD_FIFO, ASRC_DMA_COUNTER, ASRC_TIMESTAMP };
+
+// One lab5 run: RX clock off by ppm
+static int uptime(double ppm, int mode)
+{
+	const double fsRx = FS * (1.0 + ppm * 1e-6), tRx = BLOCK / fsRx, tTx = BLOCK / FS;
+	const size_t txBlocks = (size_t)(UPTIME_S * FS / BLOCK);
+	std::vector<int16_t> mem(FIFO_SIZE), in(BLOCK), y(txBlocks * BLOCK);
+	SpscRing_t fifo;
+	SPSC_Init(&fifo, mem.data(), FIFO_SIZE);
+	static Asrc_t a;
+	ASRC_Init(&a, TARGET, LOOP_HZ, BLOCK, 1000.0F);
+
+	unsigned long nIn = 0, dropped = 0, skipped = 0, r = 1;
+	double tNextRx = 0.0, tLastRx = -1.0, maxErr = 0.0, sumDelta = 0.0;
+	unsigned long settled = 0;
+	for(size_t k = 0; k < txBlocks; k++)
+	{
+		const double t = 0.37e-3 + k * tTx;
+		// RX blocks up to now
+		for(; tNextRx <= t; tNextRx += tRx)
+		{
+			for(int16_t &v : in) v = (int16_t)lrint(16384.0 * sin(2.0 * M_PI * 1000.0 * (double)nIn++ / fsRx));
+			dropped += BLOCK - SPSC_WriteBlock(&fifo, in.data(), BLOCK);
+			tLastRx = tNextRx;
+		}
+		int16_t *out = &y[k * BLOCK];
+		if(mode != OLD_FIFO)
+		{
+			// FIFO count plus the samples of the RX half being filled
+			double part = (t - tLastRx) * fsRx;
+			r = r * 6364136223846793005UL + 1442695040888963407UL;
+			if(mode == ASRC_DMA_COUNTER) part = floor(part * DECIM / 16.0) * 16.0 / DECIM;
+			else part += 0.06 * ((double)(r >> 40) / (double)(1UL << 24) - 0.5);
+			ASRC_Update(&a, (float)(SPSC_Count(&fifo) + part));
+			ASRC_Process(&a, &fifo, out, BLOCK);
+			if(t > SETTLE_S)
+			{
+				maxErr = fmax(maxErr, fabs(a.error));
+				sumDelta += a.delta;
+				settled++;
+			}
+		}
+		else if(SPSC_Count(&fifo) >= BLOCK) SPSC_ReadBlock(&fifo, out, BLOCK);
+		else
+		{
+			// The old AudioFifoToTx(): the half keeps its last samples
+			if(k) for(int n = 0; n < BLOCK; n++) out[n] = out[n - BLOCK];
+			skipped++;
+		}
+	}
+
+	if(mode == OLD_FIFO)
+	{
+		printf("    %+5.0f ppm  old FIFO:   %5lu blocks repeated, %7lu samples dropped\n", ppm, skipped, dropped);
+		return 0;
+	}
+	const double s = sinad(y, y.size() - (size_t)(10 * FS), 1000.0 / FS);
+	// Mean ratio over the settled blocks against the clock ratio
+	const double ppmErr = (sumDelta / (double)settled / 4294967296.0 + 1.0 - fsRx / FS) * 1e6;
+	const bool ok = a.underruns == 0 && dropped == 0 && maxErr < 1.0 && fabs(ppmErr) < MAX_RATIO_PPM && s > 80.0;
+	printf("    %+5.0f ppm  ASRC %-7s underruns %lu, dropped %lu | level error %.2f samples | ratio off %+.4f ppm | SINAD %5.1f dB %s\n",
+			ppm, mode == ASRC_DMA_COUNTER ? "(DMA):" : "(DWT):", (unsigned long)a.underruns, dropped, maxErr, ppmErr, s,
+			mode == ASRC_DMA_COUNTER ? "" : (ok ? "ok" : "FAIL"));
+	return (ok || mode == ASRC_DMA_COUNTER) ? 0 : 1;
+}
+
+static void speed()
+{
+	static Asrc_t a;
+	ASRC_Init(&a, 0.0F, LOOP_HZ, BLOCK, 1000.0F);
+	a.started = 1;
+	a.delta = 429497;		// 1.0001
+	std::vector<int16_t> mem(4096), in = std::vector<int16_t>(BLOCK + 2, 1000), y(BLOCK);
+	SpscRing_t ring;
+	SPSC_Init(&ring, mem.data(), 4096);
+	const size_t blocks = 2000;
+	const double t = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < blocks; b++)
+		{
+			SPSC_WriteBlock(&ring, in.data(), (uint32_t)in.size());
+			ASRC_Process(&a, &ring, y.data(), BLOCK);
+			SPSC_Consume(&ring, SPSC_Count(&ring) > 2 * BLOCK ? SPSC_Count(&ring) - 2 * BLOCK : 0);
+		}
+		bench::doNotOptimize(y.data());
+	}, blocks * BLOCK);
+	printf("ASRC_Process: %.1f %s/output sample (%d taps, %d phases)\n", t, bench::tickUnit(), ASRC_TAPS, ASRC_PHASES);
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	int fails = quality();
+	printf("lab5, %d min uptime, 1 kHz at -6 dBFS, FIFO target %d samples:\n", UPTIME_S / 60, TARGET);
+	for(double ppm : {100.0, -100.0, 500.0, -30.0})
+	{
+		fails += uptime(ppm, OLD_FIFO);
+		fails += uptime(ppm, ASRC_DMA_COUNTER);
+		fails += uptime(ppm, ASRC_TIMESTAMP);
+	}
+	speed();
+	return fails;
+}
@@ -0,0 +1,210 @@
+/*
+ * bench_dma_event_queue.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host check of the lab5 DMA event queue (dma_event_queue.h):
+ *  - stress: three producer threads (the DMA ISRs) post numbered half/full
+ *    events into the 16-slot queue, one consumer thread drains it, stalling
+ *    now and then so the queue overflows; per source the events must come
+ *    out in order with the right half, and received + missed must add up to
+ *    what the consumer expected, dropped to missed plus the drops after the
+ *    last event taken,
+ *  - lab5's loop as a timed model, 1 ms RX and TX halves (the TX clock 100
+ *    ppm fast), 0.3 ms per RX block, a 2.5 ms stall every 200th block: the
+ *    old single-byte flags against the queue. The flags lose halves without
+ *    a trace, the queue hands over every one and reports those that came
+ *    too late,
+ *  - cost of a post and a pop.
+ *
+ *  Build: g++ -O2 -std=c++17 -pthread bench_dma_event_queue.cpp -o bench_dma_event_queue
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "../dma_event_queue.h"
+
+/* Private define ------------------------------------------------------------*/
+#define STRESS_EVENTS	(2000000UL)		// Per producer
+#define STRESS_SOURCES	(3)
+#define MODEL_MS		(60000)			// One minute of audio
+#define SPEED_EVENTS	(1000000UL)
+
+/* Private function reference -----------------------------------------------*/
+static int stress()
+{
+	static DmaEventQueue_t q;
+	DMA_EVQ_Init(&q);
+	std::atomic<int> running(STRESS_SOURCES);
+	std::vector<std::thread> producers;
+	for(uint8_t s = 0; s < STRESS_SOURCES; s++)
+	{
+		producers.emplace_back([&, s]() {
+			for(unsigned long k = 0; k < STRESS_EVENTS; k++)
+			{
+				DMA_EVQ_Post(&q, s, (uint8_t)(k & 1));
+				if((k & 0xFF) == 0) std::this_thread::yield();
+			}
+			running--;
+		});
+	}
+
+	unsigned long received[STRESS_SOURCES] = {0}, errors = 0, r = 1;
+	uint32_t last[STRESS_SOURCES] = {0};
+	bool first[STRESS_SOURCES] = {true, true, true};
+	for(;;)
+	{
+		DmaEvent_t ev;
+		const bool more = running.load() > 0;
+		while(DMA_EVQ_Pop(&q, &ev))
+		{
+			errors += ev.source >= STRESS_SOURCES || ev.half != (ev.seq & 1);
+			errors += !first[ev.source] && ev.seq <= last[ev.source];	// In order per source
+			first[ev.source] = false;
+			last[ev.source] = ev.seq;
+			received[ev.source]++;
+			// Stall now and then: the producers fill the queue
+			r = r * 6364136223846793005UL + 1442695040888963407UL;
+			if((r >> 60) == 0) std::this_thread::yield();
+		}
+		if(!more) break;
+		std::this_thread::yield();
+	}
+	for(std::thread &t : producers) t.join();
+
+	unsigned long totalMissed = 0, totalDropped = 0;
+	for(int s = 0; s < STRESS_SOURCES; s++)
+	{
+		errors += received[s] + q.missed[s] != q.expected[s];
+		errors += q.dropped[s] != q.missed[s] + (q.posted[s] - q.expected[s]);
+		errors += q.posted[s] != STRESS_EVENTS;
+		totalMissed += q.missed[s];
+		totalDropped += q.dropped[s];
+	}
+	printf("stress: %d producers x %lu events, %lu dropped (queue full), %lu missed seen by the consumer, errors %lu %s\n",
+			STRESS_SOURCES, STRESS_EVENTS, totalDropped, totalMissed, errors, errors ? "FAIL" : "ok");
+	return errors ? 1 : 0;
+}
+
+// One interrupt of the model
+struct Isr
+{
+	double t;
+	uint8_t source, half;
+};
+
+// Main loop cost of one event in us, with a stall every 200th RX block
+static double cost(uint8_t source, unsigned long n)
+{
+	if(source == 1) return 40.0;
+	return (n % 200 == 199) ? 2500.0 : 300.0;
+}
+
+static std::vector<Isr> interrupts()
+{
+	std::vector<Isr> isr;
+	for(unsigned long k = 0; k < MODEL_MS; k++)
+	{
+		isr.push_back({1000.0 * k, 0, (uint8_t)(k & 1)});
+		isr.push_back({500.0 + 1000.0 * k / 1.0001, 1, (uint8_t)(k & 1)});
+	}
+	std::sort(isr.begin(), isr.end(), [](const Isr &a, const Isr &b) { return a.t < b.t; });
+	return isr;
+}
+
+static int model()
+{
+	const std::vector<Isr> isr = interrupts();
+
+	// Old loop: flag per stream, set by its ISR, cleared and handled by the loop
+	unsigned long lost[2] = {0}, handled[2] = {0};
+	uint8_t flag[2] = {0, 0};
+	size_t next = 0;
+	double now = 0.0;
+	auto deliver = [&]() {
+		for(; next < isr.size() && isr[next].t <= now; next++)
+		{
+			lost[isr[next].source] += flag[isr[next].source] != 0;
+			flag[isr[next].source] = (uint8_t)(isr[next].half + 1);
+		}
+	};
+	while(next < isr.size())
+	{
+		deliver();
+		bool busy = false;
+		for(uint8_t s = 0; s < 2; s++)
+		{
+			for(uint8_t h = 1; h <= 2; h++)
+			{
+				if(flag[s] != h) continue;
+				flag[s] = 0;
+				now += cost(s, handled[s]++);
+				busy = true;
+				deliver();
+			}
+		}
+		if(!busy && next < isr.size()) now = isr[next].t;
+	}
+
+	// Queue: drain in order, sleep when empty
+	static DmaEventQueue_t q;
+	DMA_EVQ_Init(&q);
+	unsigned long taken[2] = {0};
+	next = 0;
+	now = 0.0;
+	double sleep = 0.0;
+	while(next < isr.size() || !DMA_EVQ_Empty(&q))
+	{
+		for(; next < isr.size() && isr[next].t <= now; next++) DMA_EVQ_Post(&q, isr[next].source, isr[next].half);
+		DmaEvent_t ev;
+		if(DMA_EVQ_Pop(&q, &ev))
+		{
+			now += cost(ev.source, taken[ev.source]++);
+		}
+		else if(next < isr.size())
+		{
+			sleep += isr[next].t - now;		// WFI until the next interrupt
+			now = isr[next].t;
+		}
+	}
+
+	const unsigned long posted = MODEL_MS;
+	const bool ok = taken[0] == posted && taken[1] == posted && q.missed[0] + q.missed[1] == 0
+			&& q.late[0] + q.late[1] > 0 && lost[0] + lost[1] > 0;
+	printf("lab5 loop, %d s: flags   RX %lu handled, %lu lost | TX %lu handled, %lu lost (no trace)\n",
+			MODEL_MS / 1000, handled[0], lost[0], handled[1], lost[1]);
+	printf("                  queue   RX %lu handled, %u late | TX %lu handled, %u late | missed %u | asleep %.0f%% %s\n",
+			taken[0], q.late[0], taken[1], q.late[1], q.missed[0] + q.missed[1], 100.0 * sleep / now, ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+static void speed()
+{
+	static DmaEventQueue_t q;
+	DMA_EVQ_Init(&q);
+	const double t = bench::ticksPerItem([&]() {
+		DmaEvent_t ev;
+		for(unsigned long k = 0; k < SPEED_EVENTS; k++)
+		{
+			DMA_EVQ_Post(&q, (uint8_t)(k & 1), (uint8_t)((k >> 1) & 1));
+			DMA_EVQ_Pop(&q, &ev);
+		}
+		bench::doNotOptimize(&ev);
+	}, SPEED_EVENTS);
+	printf("post + pop: %.1f %s\n", t, bench::tickUnit());
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	int fails = stress();
+	fails += model();
+	speed();
+	return fails;
+}
@@ -0,0 +1,117 @@
+/*
+ * bench_fir.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark: shift-register FIR (calc_fir_filter in Lab9) against the
+ *  mirrored delay line of dsp::FirFilter, fed with AudioBuffer sized frames.
+ *  FirFilter sums in DSP_FIR_ACCUMULATORS partial sums, so the int16 outputs
+ *  may differ by one LSB.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_fir.cpp -o bench_fir
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../fir.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DMA_BUFFER_SIZE		(32)		// Same frame as Lab9
+#define NUM_SAMPLES			(1UL << 18)
+
+/* Private typedef -----------------------------------------------------------*/
+// calc_fir_filter from Lab9 generalized to M taps
+struct ShiftRegisterFir
+{
+	std::vector<float> h;
+	std::vector<float> xprev;
+
+	ShiftRegisterFir(const float *coefs, size_t M) : h(coefs, coefs + M), xprev(M - 1, 0.0F) {}
+
+	float process(float x)
+	{
+		const size_t M = h.size();
+		float y = x*h[0];
+		for(size_t i = 0; i < M - 1; i++)
+		{
+			y += xprev[i]*h[i+1];
+		}
+		for(size_t i = M - 2; i > 0; i--)
+		{
+			xprev[i] = xprev[i-1];
+		}
+		xprev[0] = x;
+		return y;
+	}
+};
+
+/* Private function reference -----------------------------------------------*/
+static int run(size_t M)
+{
+	std::vector<float> h(M);
+	for(size_t k = 0; k < M; k++) h[k] = 1.0F / (float)M;
+
+	std::vector<float> x = bench::noise(NUM_SAMPLES);
+	std::vector<int16_t> frames(NUM_SAMPLES * 2);
+	for(size_t n = 0; n < NUM_SAMPLES; n++)
+	{
+		frames[2*n] = frames[2*n + 1] = dsp::toInt16(x[n]);
+	}
+
+	// Reference: per-sample loop of Lab9
+	std::vector<int16_t> ref(frames.size());
+	double tRef = bench::ticksPerItem([&]() {
+		ShiftRegisterFir fir(h.data(), M);
+		ref = frames;
+		for(size_t f = 0; f < ref.size(); f += DMA_BUFFER_SIZE)
+		{
+			int16_t *AudioBuffer = &ref[f];
+			for(int n = 0; n < DMA_BUFFER_SIZE; n += 2)
+			{
+				float y = fir.process(dsp::toFloat(AudioBuffer[n]));
+				AudioBuffer[n] = AudioBuffer[n+1] = dsp::toInt16(y);
+			}
+		}
+		bench::doNotOptimize(ref.data());
+	}, NUM_SAMPLES, 3);
+
+	// Block engine, one call per AudioBuffer frame
+	std::vector<int16_t> out(frames.size());
+	double tNew = bench::ticksPerItem([&]() {
+		dsp::FirFilter fir(h.data(), M, dsp::FIR_DIRECT);
+		out = frames;
+		for(size_t f = 0; f < out.size(); f += DMA_BUFFER_SIZE)
+		{
+			fir.processAudioBuffer(&out[f], DMA_BUFFER_SIZE);
+		}
+		bench::doNotOptimize(out.data());
+	}, NUM_SAMPLES, 3);
+
+	int maxErr = 0;
+	for(size_t n = 0; n < out.size(); n++)
+	{
+		int e = abs(out[n] - ref[n]);
+		if(e > maxErr) maxErr = e;
+	}
+
+	const bool ok = maxErr <= 1;
+	printf("%6zu taps | shift-register %9.2f | circular %9.2f %s/sample | speedup %5.2fx | max |err| %d LSB %s\n",
+			M, tRef, tNew, bench::tickUnit(), tRef / tNew, maxErr, ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	const size_t taps[] = {11, 64, 256, 1024};
+	int fails = 0;
+	for(size_t M : taps)
+	{
+		fails += run(M);
+	}
+	return fails;
+}
@@ -0,0 +1,111 @@
+/*
+ * bench_fir_fft.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark: direct form dsp::FirFilter against the overlap-save
+ *  dsp::FftConvolver, fed with 16-sample frames (one Lab9 AudioBuffer channel).
+ *  Prints the measured crossover used for DSP_FIR_FFT_CROSSOVER and checks the
+ *  FFT output against the direct output delayed by latency(). Also checks that
+ *  dsp::FirEngine keeps the direct-form delay unless the FFT path is asked for,
+ *  and that a convolver without taps outputs zeros.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_fir_fft.cpp -o bench_fir_fft
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../fir.h"
+#include "../fir_fft.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FRAME_SIZE			(16)		// Left samples in a DMA_BUFFER_SIZE frame
+#define NUM_SAMPLES			(1UL << 17)
+
+/* Private function reference -----------------------------------------------*/
+static bool run(size_t M)
+{
+	std::vector<float> h(M);
+	const double wc = 0.1 * M_PI, c = (M - 1) / 2.0;
+	for(size_t k = 0; k < M; k++)
+	{
+		double m = (double)k - c;
+		double w = 0.54 - 0.46 * cos(2.0 * M_PI * (double)k / (double)(M - 1));
+		h[k] = (float)(w * ((m == 0.0) ? wc / M_PI : sin(wc * m) / (M_PI * m)));
+	}
+
+	std::vector<float> x = bench::noise(NUM_SAMPLES);
+	std::vector<float> ref(NUM_SAMPLES), out(NUM_SAMPLES);
+
+	double tRef = bench::ticksPerItem([&]() {
+		dsp::FirFilter fir(h.data(), M);
+		for(size_t f = 0; f < NUM_SAMPLES; f += FRAME_SIZE)
+		{
+			fir.process(&x[f], &ref[f], FRAME_SIZE);
+		}
+		bench::doNotOptimize(ref.data());
+	}, NUM_SAMPLES, 3);
+
+	size_t latency = 0, nfft = 0;
+	double tFft = bench::ticksPerItem([&]() {
+		dsp::FftConvolver fir(h.data(), M);
+		latency = fir.latency();
+		nfft = fir.fftSize();
+		for(size_t f = 0; f < NUM_SAMPLES; f += FRAME_SIZE)
+		{
+			fir.process(&x[f], &out[f], FRAME_SIZE);
+		}
+		bench::doNotOptimize(out.data());
+	}, NUM_SAMPLES, 3);
+
+	float maxErr = 0.0F;
+	for(size_t n = latency; n < NUM_SAMPLES; n++)
+	{
+		maxErr = fmaxf(maxErr, fabsf(out[n] - ref[n - latency]));
+	}
+
+	printf("%5zu taps | direct %8.2f | fft(N=%5zu) %8.2f %s/sample | speedup %6.2fx | latency %5zu | max |err| %.2e\n",
+			M, tRef, nfft, tFft, bench::tickUnit(), tRef / tFft, latency, maxErr);
+	return tFft < tRef;
+}
+
+static int engine()
+{
+	std::vector<float> h(101, 1.0F / 101.0F), x = bench::noise(4096), ref(4096), y(4096);
+	dsp::FirFilter direct(h.data(), h.size());
+	dsp::FirEngine def(h.data(), h.size()), autoFft(h.data(), h.size(), dsp::FIR_METHOD_AUTO);
+	direct.process(x.data(), ref.data(), x.size());
+	def.process(x.data(), y.data(), x.size());
+	float maxErr = 0.0F;
+	for(size_t n = 0; n < x.size(); n++) maxErr = fmaxf(maxErr, fabsf(y[n] - ref[n]));
+
+	dsp::FftConvolver empty(h.data(), 0);
+	empty.process(x.data(), y.data(), x.size());
+	float maxZero = 0.0F;
+	for(float v : y) maxZero = fmaxf(maxZero, fabsf(v));
+
+	const bool ok = def.method() == dsp::FIR_METHOD_DIRECT && def.latency() == 0 && maxErr < 1e-5F
+			&& autoFft.method() == dsp::FIR_METHOD_FFT && maxZero == 0.0F;
+	printf("FirEngine 101 taps: default latency %zu, max |err| vs FirFilter %.2e | AUTO latency %zu | 0 taps max |y| %.1f %s\n",
+			def.latency(), maxErr, autoFft.latency(), maxZero, ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	const size_t taps[] = {16, 32, 48, 64, 96, 128, 256, 512, 1024, 4096};
+	size_t crossover = 0;
+	for(size_t M : taps)
+	{
+		bool fftWins = run(M);
+		if(fftWins && !crossover) crossover = M;
+		if(!fftWins) crossover = 0;
+	}
+	printf("Measured crossover: %zu taps (DSP_FIR_FFT_CROSSOVER = %d)\n", crossover, DSP_FIR_FFT_CROSSOVER);
+	return engine();
+}
@@ -0,0 +1,135 @@
+/*
+ * bench_fir_q15.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark: float pipeline of Lab9 (TOFLOAT, float FIR, clip, TOINT16)
+ *  against the Q15 and Q31-tap fixed-point FIRs on the interleaved int16
+ *  AudioBuffer. Reports cycles/sample and the error in LSB against float,
+ *  and checks Q15_Scale at the ends of its shift range (clamped, no UB).
+ *
+ *  Build: g++ -O2 -std=c++17 bench_fir_q15.cpp -o bench_fir_q15
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../fir.h"
+#include "../fir_q15.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DMA_BUFFER_SIZE		(32)
+#define NUM_SAMPLES			(1UL << 18)
+
+/* Private function reference -----------------------------------------------*/
+static int maxLsbError(const std::vector<int16_t> &a, const std::vector<int16_t> &b)
+{
+	int e = 0;
+	for(size_t n = 0; n < a.size(); n++)
+	{
+		int d = abs(a[n] - b[n]);
+		if(d > e) e = d;
+	}
+	return e;
+}
+
+static void run(const char *name, const std::vector<float> &h)
+{
+	const uint16_t M = (uint16_t)h.size();
+	std::vector<float> x = bench::noise(NUM_SAMPLES);
+	std::vector<int16_t> frames(NUM_SAMPLES * 2);
+	for(size_t n = 0; n < NUM_SAMPLES; n++)
+	{
+		frames[2*n] = frames[2*n + 1] = dsp::toInt16(x[n]);
+	}
+
+	std::vector<int16_t> ref(frames.size()), q15(frames.size()), q31(frames.size());
+	double tRef = bench::ticksPerItem([&]() {
+		dsp::FirFilter fir(h.data(), M);
+		ref = frames;
+		for(size_t f = 0; f < ref.size(); f += DMA_BUFFER_SIZE)
+		{
+			fir.processAudioBuffer(&ref[f], DMA_BUFFER_SIZE);
+		}
+		bench::doNotOptimize(ref.data());
+	}, NUM_SAMPLES, 3);
+
+	std::vector<int16_t> h15(M), state15(2 * M);
+	FIR_Q15_Quantize(h.data(), h15.data(), M);
+	FirQ15_t fir15;
+	double t15 = bench::ticksPerItem([&]() {
+		FIR_Q15_Init(&fir15, h15.data(), state15.data(), M);
+		q15 = frames;
+		for(size_t f = 0; f < q15.size(); f += DMA_BUFFER_SIZE)
+		{
+			FIR_Q15_ProcessAudioBuffer(&fir15, &q15[f], DMA_BUFFER_SIZE);
+		}
+		bench::doNotOptimize(q15.data());
+	}, NUM_SAMPLES, 3);
+
+	std::vector<int32_t> h31(M);
+	std::vector<int16_t> state31(2 * M);
+	FIR_Q31_Quantize(h.data(), h31.data(), M);
+	FirQ31_t fir31;
+	double t31 = bench::ticksPerItem([&]() {
+		FIR_Q31_Init(&fir31, h31.data(), state31.data(), M);
+		q31 = frames;
+		for(size_t f = 0; f < q31.size(); f += DMA_BUFFER_SIZE)
+		{
+			FIR_Q31_ProcessAudioBuffer(&fir31, &q31[f], DMA_BUFFER_SIZE);
+		}
+		bench::doNotOptimize(q31.data());
+	}, NUM_SAMPLES, 3);
+
+	printf("%-10s %4u taps | float %7.2f | q15 %7.2f (%s acc, err %d LSB) | q31 %7.2f (err %d LSB) %s/sample\n",
+			name, M, tRef, t15, fir15.acc32 ? "32-bit" : "64-bit", maxLsbError(q15, ref),
+			t31, maxLsbError(q31, ref), bench::tickUnit());
+}
+
+// Q15_Scale with shifts past both ends: rounds to 0 / saturates, as the clamp
+static int scaleRange()
+{
+	const int16_t x[4] = {32767, -32768, 1, -1};
+	const int8_t shifts[] = {-17, -20, -128, 16, 20, 127};
+	int fails = 0;
+	for(int8_t s : shifts)
+	{
+		int16_t y[4] = {x[0], x[1], x[2], x[3]};
+		Q15_Scale(y, 4, 1, 32767, s);
+		bool ok = true;
+		for(int k = 0; k < 4; k++) ok &= y[k] == (s < 0 ? 0 : x[k] > 0 ? 32767 : -32768);
+		fails += !ok;
+		printf("Q15_Scale shift %4d: %6d %6d %6d %6d %s\n", s, y[0], y[1], y[2], y[3], ok ? "ok" : "FAIL");
+	}
+	return fails;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	// fir_filt_coefs of Lab9
+	std::vector<float> lab9 = {0.01131245456295710584F, 0.02660055636482243011F, 0.06864020619336545781F,
+			0.12482787853108187615F, 0.17280429834737529027F, 0.19162921200079557904F,
+			0.17280429834737529027F, 0.12482787853108187615F, 0.06864020619336545781F,
+			0.02660055636482243011F, 0.01131245456295710584F};
+	run("lab9", lab9);
+
+	// Hamming low-pass with a low cutoff, many small taps
+	const size_t lengths[] = {101, 255};
+	for(size_t M : lengths)
+	{
+		std::vector<float> h(M);
+		const double wc = 2.0 * M_PI * 200.0 / 48000.0, c = (M - 1) / 2.0;
+		for(size_t k = 0; k < M; k++)
+		{
+			double m = (double)k - c;
+			double w = 0.54 - 0.46 * cos(2.0 * M_PI * (double)k / (double)(M - 1));
+			h[k] = (float)(w * ((m == 0.0) ? wc / M_PI : sin(wc * m) / (M_PI * m)));
+		}
+		run("lowpass", h);
+	}
+	return scaleRange();
+}
@@ -0,0 +1,82 @@
+/*
+ * bench_fir_simd.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark: scalar dsp::FirFilter against the vectorized kernels of
+ *  dsp::FirSimdFilter, one run per instruction set the CPU supports. Every run
+ *  is checked against the scalar output with firSimdTolerance().
+ *
+ *  Build: g++ -O2 -std=c++17 bench_fir_simd.cpp -o bench_fir_simd
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../fir.h"
+#include "../fir_simd.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NUM_SAMPLES			(1UL << 18)
+#define NOISE_AMP			(0.5F)
+
+/* Private function reference -----------------------------------------------*/
+static int run(size_t M)
+{
+	std::vector<float> h(M);
+	for(size_t k = 0; k < M; k++) h[k] = sinf(0.37F * (float)k + 0.1F) / (float)M;
+
+	std::vector<float> x = bench::noise(NUM_SAMPLES, NOISE_AMP);
+	std::vector<float> ref(NUM_SAMPLES), out(NUM_SAMPLES);
+
+	double tRef = bench::ticksPerItem([&]() {
+		dsp::FirFilter fir(h.data(), M);
+		fir.process(x.data(), ref.data(), NUM_SAMPLES);
+		bench::doNotOptimize(ref.data());
+	}, NUM_SAMPLES, 3);
+	printf("%5zu taps | %-7s %9.2f %s/sample\n", M, "ref", tRef, bench::tickUnit());
+
+	const float tol = dsp::firSimdTolerance(h.data(), M, NOISE_AMP);
+	const dsp::FirIsa best = dsp::firDetectIsa();
+	int fails = 0;
+	for(int isa = dsp::FIR_ISA_SCALAR; isa <= best; isa++)
+	{
+		double t = bench::ticksPerItem([&]() {
+			dsp::FirSimdFilter fir(h.data(), M);
+			fir.setIsa((dsp::FirIsa)isa);
+			fir.process(x.data(), out.data(), NUM_SAMPLES);
+			bench::doNotOptimize(out.data());
+		}, NUM_SAMPLES, 3);
+
+		float maxErr = 0.0F;
+		for(size_t n = 0; n < NUM_SAMPLES; n++)
+		{
+			float e = fabsf(out[n] - ref[n]);
+			if(e > maxErr) maxErr = e;
+		}
+		bool ok = maxErr <= tol;
+		fails += !ok;
+
+		printf("%5zu taps | %-7s %9.2f %s/sample | speedup %6.2fx | max |err| %.2e (tol %.2e) %s\n",
+				M, dsp::firIsaName((dsp::FirIsa)isa), t, bench::tickUnit(), tRef / t,
+				maxErr, tol, ok ? "OK" : "FAIL");
+	}
+	return fails;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	printf("Detected ISA: %s\n", dsp::firIsaName(dsp::firDetectIsa()));
+
+	const size_t taps[] = {11, 64, 256, 1024};
+	int fails = 0;
+	for(size_t M : taps)
+	{
+		fails += run(M);
+	}
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * bench_fir_static.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark: runtime-taps dsp::FirFilter against the compile-time
+ *  dsp::Fir<N, Coeffs>, both designed as in Clase-11-Abril (Fc = 500 Hz at
+ *  8 kHz). Also checks the constexpr design against a runtime sin() design.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_fir_static.cpp -o bench_fir_static
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../fir.h"
+#include "../fir_static.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DMA_BUFFER_SIZE		(32)
+#define NUM_SAMPLES			(1UL << 18)
+#define FIR_WC				(2.0*DSP_PI*500.0/8000.0)
+
+/* Private variables ---------------------------------------------------------*/
+static constexpr auto h11 = dsp::firLowPassConst<11>(FIR_WC);
+static constexpr auto h32 = dsp::firLowPassConst<32>(FIR_WC, dsp::FIR_CONST_HAMMING);
+static constexpr auto h64 = dsp::firLowPassConst<64>(FIR_WC, dsp::FIR_CONST_HAMMING);
+static constexpr auto h101 = dsp::firLowPassConst<101>(FIR_WC, dsp::FIR_CONST_HAMMING);
+
+/* Private function reference -----------------------------------------------*/
+// Design error of the constexpr sinc against libm
+template <size_t N>
+static double designError(const std::array<float, N> &h, bool hamming)
+{
+	double err = 0.0, c = (N - 1) / 2.0;
+	for(size_t k = 0; k < N; k++)
+	{
+		double m = (double)k - c;
+		double v = (m == 0.0) ? FIR_WC / M_PI : sin(FIR_WC * m) / (M_PI * m);
+		if(hamming) v *= 0.54 - 0.46 * cos(2.0 * M_PI * (double)k / (double)(N - 1));
+		err = fmax(err, fabs(v - (double)h[k]));
+	}
+	return err;
+}
+
+template <size_t N, const std::array<float, N> &Coeffs>
+static void run(bool hamming)
+{
+	std::vector<float> x = bench::noise(NUM_SAMPLES);
+	std::vector<float> ref(NUM_SAMPLES), out(NUM_SAMPLES);
+
+	double tRef = bench::ticksPerItem([&]() {
+		dsp::FirFilter fir(Coeffs.data(), N, dsp::FIR_DIRECT);
+		for(size_t f = 0; f < NUM_SAMPLES; f += DMA_BUFFER_SIZE)
+		{
+			fir.process(&x[f], &ref[f], DMA_BUFFER_SIZE);
+		}
+		bench::doNotOptimize(ref.data());
+	}, NUM_SAMPLES, 3);
+
+	double tNew = bench::ticksPerItem([&]() {
+		dsp::Fir<N, Coeffs> fir;
+		for(size_t f = 0; f < NUM_SAMPLES; f += DMA_BUFFER_SIZE)
+		{
+			fir.process(&x[f], &out[f], DMA_BUFFER_SIZE);
+		}
+		bench::doNotOptimize(out.data());
+	}, NUM_SAMPLES, 3);
+
+	float maxErr = 0.0F;
+	for(size_t n = 0; n < NUM_SAMPLES; n++)
+	{
+		maxErr = fmaxf(maxErr, fabsf(out[n] - ref[n]));
+	}
+
+	printf("%4zu taps | runtime %8.2f | template %8.2f %s/sample | speedup %5.2fx | max |err| %.2e | design err %.2e\n",
+			N, tRef, tNew, bench::tickUnit(), tRef / tNew, maxErr, designError(Coeffs, hamming));
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	run<11, h11>(false);
+	run<32, h32>(true);
+	run<64, h64>(true);
+	run<101, h101>(true);
+	return 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * bench_iir.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark: IIR filters of increasing order run as
+ *  - a generic direct-form IIR, one sample at a time (the usual
+ *    y(n) = sum b(k)x(n-k) - sum a(k)y(n-k) loop, in float),
+ *  - SosCascade, the same transfer function factored into biquads and
+ *    processed block by block.
+ *  Errors are the max absolute deviation from the exact sections run in
+ *  double precision. The order 2 case is the Lab10
+ *  filter; the others are low-pass prototypes with poles close to z = 1,
+ *  where the float direct form breaks down. Past order 8 these poles are no
+ *  longer determined by the double transfer function either (roots of a
+ *  clustered polynomial), so such filters have to be designed as sections.
+ *  The "delay" cases have leading zeros in b (pure delays), which tfToSos()
+ *  has to keep: a lost delay shows up as an error of the order of the peak.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_iir.cpp -o bench_iir
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../iir.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NUM_SAMPLES		(1UL << 18)
+#define BLOCK_SIZE		(256)
+
+/* Private typedef -----------------------------------------------------------*/
+template <typename T>
+struct DirectIir
+{
+	std::vector<T> b, a, xh, yh;	// a excludes a0 = 1
+
+	DirectIir(const std::vector<double> &bd, const std::vector<double> &ad)
+		: b(bd.begin(), bd.end()), a(ad.begin(), ad.end()), xh(bd.size(), 0), yh(ad.size() + 1, 0) {}
+
+	T process(T x)
+	{
+		// Linear histories: shift, then dot product
+		for(size_t k = xh.size() - 1; k > 0; k--) xh[k] = xh[k - 1];
+		xh[0] = x;
+		T y = 0;
+		for(size_t k = 0; k < b.size(); k++) y += b[k] * xh[k];
+		for(size_t k = 0; k < a.size(); k++) y -= a[k] * yh[k];
+		for(size_t k = yh.size() - 1; k > 0; k--) yh[k] = yh[k - 1];
+		yh[0] = y;
+		return y;
+	}
+};
+
+/* Private function reference -----------------------------------------------*/
+static std::vector<double> polyMul(const std::vector<double> &p, const std::vector<double> &q)
+{
+	std::vector<double> r(p.size() + q.size() - 1, 0.0);
+	for(size_t i = 0; i < p.size(); i++)
+		for(size_t j = 0; j < q.size(); j++) r[i + j] += p[i] * q[j];
+	return r;
+}
+
+// N/2 pole pairs of radius close to 1 spread below wc, zeros at z = -1, unity DC gain
+static void lowPassPrototype(size_t N, double wc, std::vector<double> &b, std::vector<double> &a,
+		std::vector<std::vector<double>> &sections)
+{
+	std::vector<double> num = {1.0}, den = {1.0};
+	sections.clear();
+	for(size_t k = 0; k < N / 2; k++)
+	{
+		double theta = wc * (double)(k + 1) / (double)(N / 2);
+		double r = 0.995 - 0.01 * (double)k;
+		double a1 = -2.0 * r * cos(theta), a2 = r * r;
+		double g = (1.0 + a1 + a2) / 4.0;
+		sections.push_back({g, 2.0 * g, g, a1, a2});
+		num = polyMul(num, {g, 2.0 * g, g});
+		den = polyMul(den, {1.0, a1, a2});
+	}
+	b = num;
+	a.assign(den.begin() + 1, den.end());
+}
+
+// Reference: the exact sections {b0, b1, b2, a1, a2} in double precision
+static std::vector<double> cascadeRef(const std::vector<std::vector<double>> &sections, const std::vector<float> &x)
+{
+	std::vector<double> y(x.begin(), x.end());
+	for(const std::vector<double> &q : sections)
+	{
+		double z1 = 0.0, z2 = 0.0;
+		for(double &v : y)
+		{
+			double out = q[0] * v + z1;
+			z1 = q[1] * v - q[3] * out + z2;
+			z2 = q[2] * v - q[4] * out;
+			v = out;
+		}
+	}
+	return y;
+}
+
+// Returns the SosCascade error
+static double run(const char *name, const std::vector<double> &b, const std::vector<double> &a,
+		const std::vector<std::vector<double>> &sections)
+{
+	std::vector<float> x = bench::noise(NUM_SAMPLES);
+	std::vector<double> ref = cascadeRef(sections, x);
+
+	std::vector<float> yd(NUM_SAMPLES), ys(NUM_SAMPLES);
+	double tDirect = bench::ticksPerItem([&]() {
+		DirectIir<float> f(b, a);
+		for(size_t n = 0; n < NUM_SAMPLES; n++) yd[n] = f.process(x[n]);
+		bench::doNotOptimize(yd.data());
+	}, NUM_SAMPLES, 3);
+
+	dsp::SosCascade sos(b.data(), b.size(), a.data(), a.size());
+	double tSos = bench::ticksPerItem([&]() {
+		sos.reset();
+		for(size_t n = 0; n < NUM_SAMPLES; n += BLOCK_SIZE) sos.process(&x[n], &ys[n], BLOCK_SIZE);
+		bench::doNotOptimize(ys.data());
+	}, NUM_SAMPLES, 3);
+
+	double eDirect = 0.0, eSos = 0.0, peak = 0.0;
+	for(size_t n = 0; n < NUM_SAMPLES; n++)
+	{
+		eDirect = fmax(eDirect, fabs((double)yd[n] - ref[n]));
+		eSos = fmax(eSos, fabs((double)ys[n] - ref[n]));
+		peak = fmax(peak, fabs(ref[n]));
+	}
+
+	printf("%-8s order %2zu (%zu sections) | direct %6.2f (err %8.1e) | sos %6.2f (err %8.1e) %s/sample | speedup %5.2fx | peak %.2f\n",
+			name, a.size(), sos.numSections(), tDirect, eDirect, tSos, eSos, bench::tickUnit(), tDirect / tSos, peak);
+	return eSos;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	// Laboratory/Lab10/coefs
+	const std::vector<double> b10 = {0.097631072937818, 0.195262145875635, 0.097631072937818};
+	const std::vector<double> a10 = {-0.942809041582063, 0.333333333333333};
+	run("Lab10", b10, a10, {{b10[0], b10[1], b10[2], a10[0], a10[1]}});
+
+	const size_t orders[] = {4, 6, 8};
+	for(size_t N : orders)
+	{
+		std::vector<double> b, a;
+		std::vector<std::vector<double>> sections;
+		lowPassPrototype(N, 0.05, b, a, sections);
+		run("low-pass", b, a, sections);
+	}
+
+	// Leading zeros of b: one delay in the b2 of a first-order zero, and two
+	// delays next to a zero pair
+	int fails = 0;
+	const std::vector<std::vector<double>> delay1 = {{0.0, 1.0, 1.0, -0.5, 0.1}};
+	const std::vector<std::vector<double>> delay2 = {{0.0, 0.0, 1.0, -0.5, 0.1}, {1.0, -0.6, 0.25, -0.9, 0.3}};
+	for(const std::vector<std::vector<double>> &q : {delay1, delay2})
+	{
+		std::vector<double> b = {1.0}, den = {1.0};
+		for(const std::vector<double> &c : q)
+		{
+			b = polyMul(b, {c[0], c[1], c[2]});
+			den = polyMul(den, {1.0, c[3], c[4]});
+		}
+		const std::vector<double> a(den.begin() + 1, den.end());
+		const bool ok = run("delay", b, a, q) < 1e-5;
+		printf("    leading zeros of b kept: %s\n", ok ? "ok" : "FAIL");
+		fails += !ok;
+	}
+	return fails;
+}
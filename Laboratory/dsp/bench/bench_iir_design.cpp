@@ -0,0 +1,152 @@
+/*
+ * bench_iir_design.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark: iirDesign() against known responses and its cost (what a
+ *  cutoff change costs on the device).
+ *  - Lab10/coefs is butter(2, 0.25): the designed sections must expand to it,
+ *  - Butterworth, prewarped: -3.01 dB at every band edge, flat passband,
+ *  - Chebyshev I, prewarped: -ripple dB at the band edges, ripple in the
+ *    passband never larger than requested,
+ *  - every pole inside the unit circle.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_iir_design.cpp -o bench_iir_design
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../iir_design.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NUM_DESIGNS		(2000)
+#define TOL_DB			(0.01)
+#define GRID			(4096)
+
+/* Private function reference -----------------------------------------------*/
+static double dB(double m) { return 20.0 * log10(m); }
+
+static bool stable(const std::vector<dsp::Biquad> &sos)
+{
+	// |a2| < 1 and |a1| < 1 + a2
+	for(const dsp::Biquad &q : sos)
+	{
+		if(fabsf(q.a2) >= 1.0F || fabsf(q.a1) >= 1.0F + q.a2) return false;
+	}
+	return true;
+}
+
+// Lowest passband gain (dB) over the passband grid
+static double passbandMin(const dsp::IirDesignSpec &s, const std::vector<dsp::Biquad> &sos)
+{
+	double lo = 1e9;
+	for(int i = 1; i < GRID; i++)
+	{
+		const double w = M_PI * i / GRID;
+		bool pass = false;
+		switch(s.type)
+		{
+		case dsp::IIR_LOWPASS: pass = w <= s.w1; break;
+		case dsp::IIR_HIGHPASS: pass = w >= s.w1; break;
+		case dsp::IIR_BANDPASS: pass = w >= s.w1 && w <= s.w2; break;
+		case dsp::IIR_BANDSTOP: pass = w <= s.w1 || w >= s.w2; break;
+		}
+		if(pass) lo = fmin(lo, dB(dsp::sosMagnitude(sos, w)));
+	}
+	return lo;
+}
+
+static double passbandMax(const dsp::IirDesignSpec &s, const std::vector<dsp::Biquad> &sos)
+{
+	double hi = -1e9;
+	for(int i = 1; i < GRID; i++)
+	{
+		const double w = M_PI * i / GRID;
+		bool stop = (s.type == dsp::IIR_LOWPASS && w > s.w1) || (s.type == dsp::IIR_HIGHPASS && w < s.w1)
+				|| (s.type == dsp::IIR_BANDPASS && (w < s.w1 || w > s.w2))
+				|| (s.type == dsp::IIR_BANDSTOP && w > s.w1 && w < s.w2);
+		if(!stop) hi = fmax(hi, dB(dsp::sosMagnitude(sos, w)));
+	}
+	return hi;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	int fails = 0;
+
+	// Laboratory/Lab10/coefs: butter(2, 0.25) with MATLAB's prewarping
+	{
+		const double b[] = {0.09763107293781750351, 0.19526214587563500702, 0.09763107293781750351};
+		const double a[] = {-0.94280904158206335630, 0.33333333333333337034};
+		dsp::IirDesignSpec s = {dsp::IIR_LOWPASS, dsp::IIR_BUTTERWORTH, 2, 0.25F * (float)M_PI, 0.0F, 0.0F, true};
+		std::vector<dsp::Biquad> sos;
+		dsp::iirDesign(s, sos);
+		const dsp::Biquad &q = sos[0];
+		double err = fmax(fmax(fabs(q.b0 - b[0]), fabs(q.b1 - b[1])), fmax(fabs(q.b2 - b[2]),
+				fmax(fabs(q.a1 - a[0]), fabs(q.a2 - a[1]))));
+		bool ok = sos.size() == 1 && err < 1e-6;
+		fails += !ok;
+		printf("Lab10 butter(2, 0.25): max coefficient error %.1e %s\n", err, ok ? "ok" : "FAIL");
+	}
+
+	static const char *types[] = {"lowpass", "highpass", "bandpass", "bandstop"};
+	static const char *families[] = {"butter", "cheby1"};
+	for(int f = 0; f < 2; f++)
+	{
+		for(int t = 0; t < 4; t++)
+		{
+			for(int N : {1, 2, 5, 8, 12})
+			{
+				dsp::IirDesignSpec s = {(dsp::IirType)t, (dsp::IirFamily)f, N, 0.1F * (float)M_PI,
+						0.3F * (float)M_PI, 0.5F, true};
+				if(t == dsp::IIR_HIGHPASS) s.w1 = 0.6F * (float)M_PI;
+				std::vector<dsp::Biquad> sos;
+				if(!dsp::iirDesign(s, sos))
+				{
+					printf("%-6s %-8s N=%2d: design FAILED\n", families[f], types[t], N);
+					fails++;
+					continue;
+				}
+
+				// Expected gain at the edges: -3.01 dB or -ripple
+				const double edge = f ? -s.rippleDb : dB(M_SQRT1_2);
+				const bool band = t >= dsp::IIR_BANDPASS;
+				double e1 = dB(dsp::sosMagnitude(sos, s.w1)), e2 = band ? dB(dsp::sosMagnitude(sos, s.w2)) : edge;
+				double lo = passbandMin(s, sos), hi = passbandMax(s, sos);
+				double t0 = bench::seconds();
+				for(int r = 0; r < NUM_DESIGNS; r++)
+				{
+					dsp::iirDesign(s, sos);
+					bench::doNotOptimize(sos.data());
+				}
+				double us = (bench::seconds() - t0) / NUM_DESIGNS * 1e6;
+
+				bool ok = stable(sos) && fabs(e1 - edge) < TOL_DB && fabs(e2 - edge) < TOL_DB
+						&& lo > edge - TOL_DB && hi < TOL_DB;
+				fails += !ok;
+				printf("%-6s %-8s N=%2d: %2zu sections | edges %7.3f %7.3f dB | passband %7.3f..%6.3f dB | %6.1f us %s\n",
+						families[f], types[t], N, sos.size(), e1, e2, lo, hi, us, ok ? "ok" : "FAIL");
+			}
+		}
+	}
+
+	// Without prewarping the edges move to 2 atan(w/2) (tutorial_1_iir.m)
+	{
+		dsp::IirDesignSpec s = {dsp::IIR_LOWPASS, dsp::IIR_BUTTERWORTH, 4, 0.5F * (float)M_PI, 0.0F, 0.0F, false};
+		std::vector<dsp::Biquad> sos;
+		dsp::iirDesign(s, sos);
+		const double wd = 2.0 * atan(s.w1 / 2.0);
+		double e = dB(dsp::sosMagnitude(sos, wd));
+		bool ok = fabs(e - dB(M_SQRT1_2)) < TOL_DB;
+		fails += !ok;
+		printf("butter lowpass N=4 unwarped: -3 dB at %.4f rad (asked %.4f): %.3f dB %s\n", wd, s.w1, e, ok ? "ok" : "FAIL");
+	}
+
+	printf("%s\n", fails ? "FAILED" : "all ok");
+	return fails ? 1 : 0;
+}
@@ -0,0 +1,191 @@
+/*
+ * bench_iir_q31.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host model of the lab5 fixed-point IIR: low-cutoff biquads at 48 kHz run
+ *  through the same iir_q31.h code the Cortex-M4 builds, with and without
+ *  error feedback, next to SosCascade in float. The error is the rms and max
+ *  deviation, in int16 LSBs, from the exact filter (double precision, same
+ *  coefficients as each implementation, so only the arithmetic noise is
+ *  measured); 0.29 rms is the int16 rounding of the output itself. The stimulus comes from a
+ *  fixed LCG, so the printed checksum of the Q31 output is a golden value: the
+ *  same stimulus through the same code on the board must give the same one.
+ *  lab5 runs its high-pass with b divided by 4 and outShift = 2 (sum|c| < 4,
+ *  overflow-free); that case fails if Init still reports it unsafe.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_iir_q31.cpp -o bench_iir_q31
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../iir.h"
+#include "../iir_q31.h"
+
+/* Private define ------------------------------------------------------------*/
+#define SAMPLE_RATE		(48000.0)
+#define NUM_SAMPLES		(BLOCK_SIZE * 20000UL)	// 20 s
+#define BLOCK_SIZE		(48)		// AUDIO_NUM_OUT_SAMPLES, 1 ms
+
+/* Private function reference -----------------------------------------------*/
+// Portable stimulus: 1 kHz and 7 Hz tones at -12 dBFS plus white noise at -40 dBFS
+static std::vector<int16_t> stimulus()
+{
+	std::vector<int16_t> x(NUM_SAMPLES);
+	uint32_t lcg = 12345;
+	for(size_t n = 0; n < NUM_SAMPLES; n++)
+	{
+		lcg = lcg * 1664525U + 1013904223U;
+		double noise = ((double)(lcg >> 8) / 16777216.0 - 0.5) * 0.02;
+		double t = (double)n / SAMPLE_RATE;
+		double v = 0.25 * sin(2.0 * M_PI * 1000.0 * t) + 0.25 * sin(2.0 * M_PI * 7.0 * t) + noise;
+		x[n] = (int16_t)lrint(v * 32768.0);
+	}
+	return x;
+}
+
+// FNV-1a over the int16 output
+static uint32_t checksum(const std::vector<int16_t> &y)
+{
+	uint32_t h = 2166136261U;
+	for(int16_t v : y)
+	{
+		h = (h ^ (uint8_t)v) * 16777619U;
+		h = (h ^ (uint8_t)((uint16_t)v >> 8)) * 16777619U;
+	}
+	return h;
+}
+
+static void lsbError(const std::vector<int16_t> &y, const std::vector<double> &ref, double &rms, double &peak)
+{
+	double acc = 0.0;
+	peak = 0.0;
+	for(size_t n = 0; n < y.size(); n++)
+	{
+		double e = (double)y[n] - ref[n] * 32768.0;
+		acc += e * e;
+		peak = fmax(peak, fabs(e));
+	}
+	rms = sqrt(acc / (double)y.size());
+}
+
+// 2nd order Butterworth sections by the bilinear transform (high = 1: high-pass)
+static dsp::Biquad butter2(double fc, int high)
+{
+	const double K = tan(M_PI * fc / SAMPLE_RATE);
+	const double n = 1.0 / (1.0 + M_SQRT2 * K + K * K);
+	dsp::Biquad q;
+	q.b0 = (float)((high ? 1.0 : K * K) * n);
+	q.b1 = (float)((high ? -2.0 : 2.0 * K * K) * n);
+	q.b2 = q.b0;
+	q.a1 = (float)(2.0 * (K * K - 1.0) * n);
+	q.a2 = (float)((1.0 - M_SQRT2 * K + K * K) * n);
+	return q;
+}
+
+// Exact output of sos in double precision
+static std::vector<double> exact(const std::vector<dsp::Biquad> &sos, const std::vector<int16_t> &x)
+{
+	std::vector<double> y(x.size());
+	for(size_t n = 0; n < x.size(); n++) y[n] = (double)x[n] / 32768.0;
+	for(const dsp::Biquad &q : sos)
+	{
+		double z1 = 0.0, z2 = 0.0;
+		for(double &v : y)
+		{
+			double out = q.b0 * v + z1;
+			z1 = q.b1 * v - q.a1 * out + z2;
+			z2 = q.b2 * v - q.a2 * out;
+			v = out;
+		}
+	}
+	return y;
+}
+
+// outShift: gain 2^outShift after the last section, as BiquadQ31_t.outShift
+static int run(const char *name, const std::vector<dsp::Biquad> &sos, uint8_t outShift = 0, bool mustBeSafe = false)
+{
+	const double g = (double)(1 << outShift);
+	const std::vector<int16_t> x = stimulus();
+	const uint8_t S = (uint8_t)sos.size();
+
+	std::vector<double> ref = exact(sos, x);
+	for(double &v : ref) v *= g;
+	std::vector<int16_t> yf(x.size());
+	double tFloat = bench::ticksPerItem([&]() {
+		dsp::SosCascade f(sos);
+		float buf[BLOCK_SIZE];
+		for(size_t n = 0; n < x.size(); n += BLOCK_SIZE)
+		{
+			for(size_t k = 0; k < BLOCK_SIZE; k++) buf[k] = (float)x[n + k] / 32768.0F;
+			f.process(buf, buf, BLOCK_SIZE);
+			for(size_t k = 0; k < BLOCK_SIZE; k++) yf[n + k] = (int16_t)lrintf(fmaxf(fminf(buf[k] * (float)g * 32768.0F, 32767.0F), -32768.0F));
+		}
+		bench::doNotOptimize(yf.data());
+	}, NUM_SAMPLES, 3);
+
+	std::vector<int32_t> coefs(S * BIQUAD_Q31_COEFS), state(S * BIQUAD_Q31_STATE);
+	BIQUAD_Q31_Quantize(&sos[0].b0, coefs.data(), S);
+
+	// Reference for the Q31 runs: the quantized coefficients, exactly
+	std::vector<dsp::Biquad> sosq(sos);
+	for(size_t k = 0; k < coefs.size(); k++) (&sosq[0].b0)[k] = (float)((double)coefs[k] / (double)(1L << BIQUAD_Q31_SHIFT));
+	std::vector<double> refq = exact(sosq, x);
+	for(double &v : refq) v *= g;
+
+	std::vector<int16_t> yq[2];
+	double tQ31[2];
+	int unsafe = 0;
+	for(int ef = 0; ef < 2; ef++)
+	{
+		yq[ef].resize(x.size());
+		tQ31[ef] = bench::ticksPerItem([&]() {
+			BiquadQ31_t bq;
+			unsafe = BIQUAD_Q31_Init(&bq, coefs.data(), state.data(), S);
+			bq.errorFeedback = (uint8_t)ef;
+			bq.outShift = outShift;
+			for(size_t n = 0; n < x.size(); n += BLOCK_SIZE)
+			{
+				BIQUAD_Q31_Process(&bq, &x[n], &yq[ef][n], BLOCK_SIZE, 1, 1);
+			}
+			bench::doNotOptimize(yq[ef].data());
+		}, NUM_SAMPLES, 3);
+	}
+
+	double rmsF, pkF, rmsR, pkR, rmsE, pkE;
+	lsbError(yf, ref, rmsF, pkF);
+	lsbError(yq[0], refq, rmsR, pkR);
+	lsbError(yq[1], refq, rmsE, pkE);
+	printf("%-14s %u sect%s | float %5.2f (%6.2f rms %6.1f max LSB) | q31 round %5.2f (%6.2f / %6.1f) | q31 ef %5.2f (%6.2f / %6.1f) %s/sample | checksum %08x\n",
+			name, S, unsafe ? " (UNSAFE)" : "", tFloat, rmsF, pkF, tQ31[0], rmsR, pkR, tQ31[1], rmsE, pkE,
+			bench::tickUnit(), checksum(yq[1]));
+	if(!mustBeSafe) return 0;
+	const bool ok = !unsafe && pkE < 2.0;
+	printf("    overflow-free, error feedback within 2 LSB: %s\n", ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	// DC blocker for the PDM microphone: as designed, and as lab5 runs it
+	int fails = 0;
+	dsp::Biquad hp = butter2(20.0, 1);
+	run("HP 20 Hz", {hp});
+	hp.b0 /= 4.0F;
+	hp.b1 /= 4.0F;
+	hp.b2 /= 4.0F;
+	fails += run("HP 20 Hz b/4", {hp}, 2, true);
+	run("LP 50 Hz", {butter2(50.0, 0)});
+	run("LP 10 Hz", {butter2(10.0, 0)});
+	run("LP 2 Hz", {butter2(2.0, 0)});
+	// Two sections (not exactly Butterworth, enough to stack the noise)
+	run("LP 30 Hz x2", {butter2(30.0, 0), butter2(30.0, 0)});
+	run("HP 5 Hz x2", {butter2(5.0, 1), butter2(5.0, 1)});
+	return fails;
+}
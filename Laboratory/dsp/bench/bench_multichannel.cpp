@@ -0,0 +1,118 @@
+/*
+ * bench_multichannel.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark: C channels of interleaved int16 frames filtered with
+ *  - one FirFilter per channel walking the interleaved buffer (the Lab9 loop
+ *    run once per channel),
+ *  - MultiChannel<FirFilter> (deinterleave, planar block filter, interleave),
+ *  - MultiChannelFir (one pass, vectorized across channels).
+ *  Cycles are per frame; outputs must match the per-channel loop. The
+ *  symmetric rows (Lab9's 11 taps, a 64-tap low-pass) fold in all three.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_multichannel.cpp -o bench_multichannel
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../fir.h"
+#include "../multichannel.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FRAMES_PER_BLOCK	(16)		// One Lab9 AudioBuffer
+#define NUM_FRAMES			(1UL << 16)
+
+/* Private function reference -----------------------------------------------*/
+static int maxLsbError(const std::vector<int16_t> &a, const std::vector<int16_t> &b)
+{
+	int e = 0;
+	for(size_t n = 0; n < a.size(); n++)
+	{
+		int d = abs(a[n] - b[n]);
+		if(d > e) e = d;
+	}
+	return e;
+}
+
+static int run(size_t C, size_t M, bool symmetric)
+{
+	std::vector<float> h(M);
+	for(size_t k = 0; k < M; k++) h[k] = sinf(0.3F * (float)k + 0.2F) / (float)M;
+	if(symmetric)
+	{
+		for(size_t k = 0; k < M; k++) h[k] = h[M - 1 - k] = 0.5F * (1.0F - cosf(2.0F * (float)M_PI * (float)(k + 1) / (float)(M + 1))) / (float)M;
+	}
+
+	std::vector<float> x = bench::noise(NUM_FRAMES * C);
+	std::vector<int16_t> frames(x.size());
+	for(size_t i = 0; i < x.size(); i++) frames[i] = dsp::toInt16(x[i]);
+	const size_t block = FRAMES_PER_BLOCK * C;
+
+	std::vector<int16_t> ref, planar, fused;
+	double tRef = bench::ticksPerItem([&]() {
+		std::vector<dsp::FirFilter> fir(C, dsp::FirFilter(h.data(), M));
+		ref = frames;
+		for(size_t f = 0; f < ref.size(); f += block)
+		{
+			for(size_t c = 0; c < C; c++)
+			{
+				for(size_t n = c; n < block; n += C)
+				{
+					ref[f + n] = dsp::toInt16(fir[c].process(dsp::toFloat(ref[f + n])));
+				}
+			}
+		}
+		bench::doNotOptimize(ref.data());
+	}, NUM_FRAMES, 3);
+
+	double tPlanar = bench::ticksPerItem([&]() {
+		dsp::MultiChannel<dsp::FirFilter> mc(C, FRAMES_PER_BLOCK);
+		for(size_t c = 0; c < C; c++) mc.channel(c).setCoefs(h.data(), M);
+		planar = frames;
+		for(size_t f = 0; f < planar.size(); f += block)
+		{
+			mc.processInterleaved(&planar[f], FRAMES_PER_BLOCK);
+		}
+		bench::doNotOptimize(planar.data());
+	}, NUM_FRAMES, 3);
+
+	double tFused = bench::ticksPerItem([&]() {
+		dsp::MultiChannelFir mc(h.data(), M, C);
+		fused = frames;
+		for(size_t f = 0; f < fused.size(); f += block)
+		{
+			mc.processInterleaved(&fused[f], FRAMES_PER_BLOCK);
+		}
+		bench::doNotOptimize(fused.data());
+	}, NUM_FRAMES, 3);
+
+	const int err = maxLsbError(planar, ref) + maxLsbError(fused, ref);
+	printf("%2zu ch %4zu taps %s | per-channel %8.2f | planar %8.2f (err %d) | fused %8.2f (err %d) %s/frame | speedup %5.2fx%s\n",
+			C, M, symmetric ? "sym " : "    ", tRef, tPlanar, maxLsbError(planar, ref), tFused, maxLsbError(fused, ref),
+			bench::tickUnit(), tRef / tFused, err > 1 ? " FAIL" : "");
+	return err > 1;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	const size_t channels[] = {2, 4, 6, 8};
+	const size_t taps[] = {11, 64};
+	int fails = 0;
+	for(bool symmetric : {false, true})
+	{
+		for(size_t M : taps)
+		{
+			for(size_t C : channels)
+			{
+				fails += run(C, M, symmetric);
+			}
+		}
+	}
+	return fails;
+}
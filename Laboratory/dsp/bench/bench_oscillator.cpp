@@ -0,0 +1,164 @@
+/*
+ * bench_oscillator.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark of OscillatorBank:
+ *  - long-run accuracy: 10 minutes at 48 kHz, the amplitude of every
+ *    oscillator against 1 and the output against sin() in double, next to
+ *    the resonator of Theory/SineWaveSynthesis in float,
+ *  - frequency changes: the output must stay continuous (no step larger than
+ *    the tone's own slope allows),
+ *  - speed: cycles per oscillator-sample of sinf(), of the bank for every ISA
+ *    the CPU supports, mixed to one channel and rendered one per channel.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_oscillator.cpp -o bench_oscillator
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../oscillator.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FS				(48000.0)
+#define NUM_OSC			(256)
+#define LONG_FRAMES		(48000UL * 600)		// 10 minutes
+#define SPEED_FRAMES	(4096)
+
+/* Private function reference -----------------------------------------------*/
+static float freq(size_t i) { return (float)(2.0 * M_PI * (50.0 + 83.7 * (double)i) / FS); }
+
+static void accuracy()
+{
+	// Four oscillators are enough for the drift, the run is long
+	const size_t N = 4;
+	dsp::OscillatorBank bank(N);
+	for(size_t i = 0; i < N; i++) bank.set(i, freq(i * 60 + 1), 1.0F);
+	std::vector<float> y(DSP_OSC_TILE * bank.padded());
+
+	// Theory/SineWaveSynthesis: impulse response of the resonator, sin(w(n+1))
+	float y1[N], y2[N], b[N], a2[N];
+	for(size_t i = 0; i < N; i++)
+	{
+		const float w = freq(i * 60 + 1);
+		b[i] = sinf(w);
+		a2[i] = 2.0F * cosf(w);
+		y1[i] = b[i];	// y[0] = sin(w) after the impulse
+		y2[i] = 0.0F;
+	}
+
+	double errBank = 0.0, errRes = 0.0, ampRes = 0.0;
+	for(unsigned long n0 = 0; n0 < LONG_FRAMES; n0 += DSP_OSC_TILE)
+	{
+		bank.render(y.data(), bank.padded(), DSP_OSC_TILE);
+		const bool last = n0 + DSP_OSC_TILE >= LONG_FRAMES;
+		for(size_t i = 0; i < N; i++)
+		{
+			for(size_t k = 0; k < DSP_OSC_TILE; k++)
+			{
+				const float yn = a2[i] * y1[i] - y2[i];
+				y2[i] = y1[i];
+				y1[i] = yn;
+			}
+			// Compare over the last tile only (n0 .. n0+TILE-1)
+			if(!last) continue;
+			const double w = freq(i * 60 + 1);
+			for(size_t k = 0; k < DSP_OSC_TILE; k++)
+			{
+				const double ref = sin(w * (double)(n0 + k));
+				errBank = fmax(errBank, fabs((double)y[k * bank.padded() + i] - ref));
+			}
+			// Amplitude from two consecutive samples: A^2 = (y1^2 + y2^2 - 2cos(w) y1 y2) / sin^2(w)
+			const double pk = sqrt(((double)y1[i] * y1[i] + (double)y2[i] * y2[i] - (double)a2[i] * y1[i] * y2[i]) / ((double)b[i] * b[i]));
+			ampRes = fmax(ampRes, fabs(pk - 1.0));
+			const double refRes = sin(w * (double)(n0 + DSP_OSC_TILE));
+			errRes = fmax(errRes, fabs((double)y1[i] - refRes));
+		}
+	}
+	// Same amplitude estimate for the bank, from its last two samples
+	double ampBank = 0.0;
+	for(size_t i = 0; i < N; i++)
+	{
+		const double w = freq(i * 60 + 1), cw = (float)cos(w), sw = (float)sin(w);
+		const double u = y[(DSP_OSC_TILE - 1) * bank.padded() + i], v = y[(DSP_OSC_TILE - 2) * bank.padded() + i];
+		ampBank = fmax(ampBank, fabs(sqrt((u * u + v * v - 2.0 * cw * u * v) / (sw * sw)) - 1.0));
+	}
+	printf("after %lu s: bank      amplitude error %.1e, error vs sin() %.1e (phase drift)\n",
+			LONG_FRAMES / 48000UL, ampBank, errBank);
+	printf("             recursion amplitude error %.1e, error vs sin() %.1e\n", ampRes, errRes);
+}
+
+static int continuity()
+{
+	// Sweep every oscillator up and down in steps at every tile
+	dsp::OscillatorBank bank(NUM_OSC);
+	for(size_t i = 0; i < NUM_OSC; i++) bank.set(i, freq(i), 0.5F);
+	const size_t P = bank.padded(), tiles = 200;
+	std::vector<float> y(DSP_OSC_TILE * tiles * P);
+	for(size_t t = 0; t < tiles; t++)
+	{
+		for(size_t i = 0; i < NUM_OSC; i++) bank.setFrequency(i, freq(i) * (1.0F + 0.5F * sinf((float)t * 0.3F)));
+		bank.render(&y[t * DSP_OSC_TILE * P], P, DSP_OSC_TILE);
+	}
+	// Largest |y[n] - y[n-1]| against amp * (2 sin(w/2)) for the fastest w used
+	double worst = 0.0;
+	for(size_t i = 0; i < NUM_OSC; i++)
+	{
+		const double limit = 0.5 * 2.0 * sin(fmin(M_PI, 1.5 * freq(i)) / 2.0) * 1.001 + 1e-6;
+		for(size_t n = 1; n < DSP_OSC_TILE * tiles; n++)
+		{
+			worst = fmax(worst, fabs((double)y[n * P + i] - y[(n - 1) * P + i]) / limit);
+		}
+	}
+	const bool ok = worst <= 1.0;
+	printf("frequency changes: largest step %.3f of the bound %s\n", worst, ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+static void speed()
+{
+	std::vector<float> y(SPEED_FRAMES);
+	double ph[NUM_OSC];
+	for(size_t i = 0; i < NUM_OSC; i++) ph[i] = 0.0;
+	double tSin = bench::ticksPerItem([&]() {
+		for(size_t n = 0; n < SPEED_FRAMES; n++)
+		{
+			float v = 0.0F;
+			for(size_t i = 0; i < NUM_OSC; i++) v += 0.01F * sinf((float)ph[i] + freq(i) * (float)n);
+			y[n] = v;
+		}
+		bench::doNotOptimize(y.data());
+	}, SPEED_FRAMES * NUM_OSC, 3);
+	printf("%d oscillators | sinf() %6.2f %s/osc-sample\n", NUM_OSC, tSin, bench::tickUnit());
+
+	for(int isa = dsp::FIR_ISA_SCALAR; isa <= dsp::firDetectIsa(); isa++)
+	{
+		dsp::OscillatorBank bank(NUM_OSC);
+		bank.setIsa((dsp::FirIsa)isa);
+		for(size_t i = 0; i < NUM_OSC; i++) bank.set(i, freq(i), 0.01F);
+		std::vector<float> out(SPEED_FRAMES * bank.padded());
+		double tMix = bench::ticksPerItem([&]() {
+			bank.mix(y.data(), SPEED_FRAMES);
+			bench::doNotOptimize(y.data());
+		}, SPEED_FRAMES * NUM_OSC, 5);
+		double tRender = bench::ticksPerItem([&]() {
+			bank.render(out.data(), bank.padded(), SPEED_FRAMES);
+			bench::doNotOptimize(out.data());
+		}, SPEED_FRAMES * NUM_OSC, 5);
+		printf("    %-6s mix %6.3f | render %6.3f %s/osc-sample | %5.1fx sinf()\n", dsp::firIsaName((dsp::FirIsa)isa),
+				tMix, tRender, bench::tickUnit(), tSin / tMix);
+	}
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	accuracy();
+	int fails = continuity();
+	speed();
+	return fails;
+}
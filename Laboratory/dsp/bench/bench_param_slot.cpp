@@ -0,0 +1,171 @@
+/*
+ * bench_param_slot.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host check of the runtime retuning path of Lab9:
+ *  - ParamSlot stress: a writer thread publishes numbered sets as fast as it
+ *    can while the reader fetches; every set the reader sees must be
+ *    complete (no torn copy) and newer than the previous one,
+ *  - cost of fetch() with and without a new set,
+ *  - a cutoff jump on a stereo tone through MultiChannelSos, switched hard
+ *    (new sections, same state), crossfaded over one block and over the
+ *    default DSP_SOS_FADE_FRAMES: the largest second difference of the
+ *    output against the steady-state one. The default fade has to take at
+ *    least MIN_FADE_DB off the hard switch.
+ *
+ *  Build: g++ -O2 -std=c++17 -pthread bench_param_slot.cpp -o bench_param_slot
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "../param_slot.h"
+#include "../iir_design.h"
+#include "../iir_simd.h"
+
+/* Private define ------------------------------------------------------------*/
+#define NUM_PUBLISH		(2000000UL)
+#define SET_WORDS		(64)
+#define FS				(48000.0F)
+#define BLOCK_FRAMES	(16)		// Lab9: DMA_BUFFER_SIZE int16 = 16 stereo frames
+#define NUM_BLOCKS		(600)
+#define MIN_FADE_DB		(12.0)		// Required click reduction of the default fade
+
+/* Private typedef -----------------------------------------------------------*/
+struct TestSet
+{
+	unsigned long seq;
+	unsigned long words[SET_WORDS];
+};
+
+/* Private function reference -----------------------------------------------*/
+static int stress()
+{
+	dsp::ParamSlot<TestSet> slot;
+	std::atomic<bool> done(false);
+	unsigned long seen = 0, torn = 0, backwards = 0, last = 0;
+
+	std::thread writer([&]() {
+		for(unsigned long s = 1; s <= NUM_PUBLISH; s++)
+		{
+			TestSet &t = slot.edit();
+			t.seq = s;
+			for(int k = 0; k < SET_WORDS; k++) t.words[k] = s * 2654435761UL + (unsigned long)k;
+			slot.publish();
+		}
+		done.store(true);
+	});
+	for(;;)
+	{
+		const bool finished = done.load();
+		if(slot.fetch())
+		{
+			const TestSet &t = slot.current();
+			for(int k = 0; k < SET_WORDS; k++) torn += t.words[k] != t.seq * 2654435761UL + (unsigned long)k;
+			backwards += t.seq <= last;
+			last = t.seq;
+			seen++;
+		}
+		if(finished && !slot.fetch()) break;
+	}
+	writer.join();
+
+	const bool ok = !torn && !backwards && last == NUM_PUBLISH;
+	printf("stress: %lu published, %lu fetched | torn %lu | out of order %lu | last %lu %s\n", NUM_PUBLISH, seen,
+			torn, backwards, last, ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+static void fetchCost()
+{
+	dsp::ParamSlot<TestSet> slot;
+	const size_t N = 1000000;
+	unsigned long acc = 0;
+	double tIdle = bench::ticksPerItem([&]() {
+		for(size_t n = 0; n < N; n++) acc += slot.fetch();
+	}, N, 3);
+	double tNew = bench::ticksPerItem([&]() {
+		for(size_t n = 0; n < N; n++)
+		{
+			slot.publish();
+			acc += slot.fetch();
+		}
+	}, N, 3);
+	bench::doNotOptimize(&acc);
+	printf("fetch: %.2f %s idle, %.2f %s publish + fetch\n", tIdle, bench::tickUnit(), tNew, bench::tickUnit());
+}
+
+static std::vector<dsp::Biquad> lowpass(float fc)
+{
+	dsp::IirDesignSpec s = {dsp::IIR_LOWPASS, dsp::IIR_BUTTERWORTH, 4, 2.0F * (float)M_PI * fc / FS, 0.0F, 0.0F, true};
+	std::vector<dsp::Biquad> sos;
+	dsp::iirDesign(s, sos);
+	return sos;
+}
+
+// Largest |y[n] - 2y[n-1] + y[n-2]| in blocks [b0, b1): a click is a jump in
+// the output or its slope, a low tone has a tiny second difference
+static float maxCurl(const std::vector<float> &y, size_t b0, size_t b1)
+{
+	float m = 0.0F;
+	for(size_t n = b0 * BLOCK_FRAMES; n < b1 * BLOCK_FRAMES; n++)
+	{
+		if(n < 2) continue;
+		for(size_t c = 0; c < 2; c++) m = fmaxf(m, fabsf(y[2 * n + c] - 2.0F * y[2 * (n - 1) + c] + y[2 * (n - 2) + c]));
+	}
+	return m;
+}
+
+static int zipper(float f0, float f1)
+{
+	// 200 Hz tone at -6 dBFS, cutoff f0 -> f1 half way
+	const size_t frames = BLOCK_FRAMES * NUM_BLOCKS, sw = NUM_BLOCKS / 2;
+	std::vector<float> x(2 * frames);
+	for(size_t n = 0; n < frames; n++) x[2 * n] = x[2 * n + 1] = 0.5F * sinf(2.0F * (float)M_PI * 200.0F * (float)n / FS);
+	const std::vector<dsp::Biquad> a = lowpass(f0), b = lowpass(f1);
+
+	std::vector<float> yHard(x.size()), yBlock(x.size()), yFade(x.size());
+	dsp::MultiChannelSos hard(a, 2), block(a, 2), fade(a, 2);
+	block.setFadeFrames(BLOCK_FRAMES);
+	for(size_t k = 0; k < NUM_BLOCKS; k++)
+	{
+		const size_t o = 2 * k * BLOCK_FRAMES;
+		if(k == sw)
+		{
+			hard.update(b.data(), b.size(), false);
+			block.update(b.data(), b.size());
+			fade.update(b.data(), b.size());
+		}
+		hard.process(&x[o], &yHard[o], BLOCK_FRAMES);
+		block.process(&x[o], &yBlock[o], BLOCK_FRAMES);
+		fade.process(&x[o], &yFade[o], BLOCK_FRAMES);
+	}
+
+	const float steady = fmaxf(maxCurl(yFade, 100, sw), maxCurl(yFade, sw + 100, NUM_BLOCKS));
+	const float cHard = maxCurl(yHard, sw, sw + 100), cBlock = maxCurl(yBlock, sw, sw + 100);
+	const float cFade = maxCurl(yFade, sw, sw + 100);
+	const double dB = 20.0 * log10(cHard / cFade);
+	const bool ok = dB >= MIN_FADE_DB;
+	printf("cutoff %4.0f -> %4.0f Hz: 2nd difference steady %.5f | hard %.5f | %d-frame fade %.5f (%4.1f dB less)"
+			" | %d-frame fade %.5f (%4.1f dB less) %s\n", f0, f1, steady, cHard, BLOCK_FRAMES, cBlock,
+			20.0 * log10(cHard / cBlock), DSP_SOS_FADE_FRAMES, cFade, dB, ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	int fails = stress();
+	fetchCost();
+	fails += zipper(1000.0F, 1260.0F);
+	fails += zipper(1260.0F, 1000.0F);
+	fails += zipper(4000.0F, 250.0F);
+	fails += zipper(250.0F, 4000.0F);
+	return fails;
+}
@@ -0,0 +1,198 @@
+/*
+ * bench_pdm_decim.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark of the PDM decimator (pdm_decim.h), for D = 32 (lab5) and
+ *  64, CIC orders 4 and 5 and every front end (LUT4/8/16):
+ *  - exactness: a sigma-delta bitstream in blocks of random size against a
+ *    double precision model that runs the CIC bit by bit as N integrators
+ *    and N combs; the int16 outputs may differ by one LSB (float rounding),
+ *  - response of the designed chain: passband ripple up to PDM_DEC_PASSBAND
+ *    and the worst gain of anything that aliases into the passband (fails
+ *    above MAX_ALIAS_DB),
+ *  - SINAD of a 1 kHz sine at -6 dBFS through the modulator and back (the
+ *    2nd order modulator's own noise floor is part of it, fails below
+ *    MIN_SINAD_DB()),
+ *  - cycles per millisecond of audio against the table size.
+ *
+ *  Build: g++ -O2 -std=c++17 bench_pdm_decim.cpp -o bench_pdm_decim
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include "bench_util.h"
+#include "../pdm_decim.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FS_PDM			(1536000.0)
+#define TEST_MS			(2000)
+#define MAX_ALIAS_DB	(-70.0)		// Every configuration measures -73 or less
+#define MIN_SINAD_DB(D)	((D) == 32 ? 52.0 : 68.0)	// Measured 53.7 and 69.8 dB
+
+/* Private function reference -----------------------------------------------*/
+// Sigma-delta bitstream of a sine at amp, f Hz, ms milliseconds at FS_PDM
+static std::vector<uint16_t> stimulus(double amp, double f, size_t ms)
+{
+	const size_t bits = (size_t)(FS_PDM / 1000.0) * ms;
+	std::vector<float> x(bits);
+	for(size_t n = 0; n < bits; n++) x[n] = (float)(amp * sin(2.0 * M_PI * f * (double)n / FS_PDM));
+	std::vector<uint16_t> pdm(bits / 16);
+	PdmModulator_t mod;
+	PDM_MOD_Init(&mod);
+	PDM_MOD_Process(&mod, x.data(), pdm.data(), bits);
+	return pdm;
+}
+
+// Double model: bit-serial CIC (integrators, decimation, combs), then the FIRs
+static std::vector<int16_t> reference(const PdmDecimator_t &dec, const std::vector<uint16_t> &pdm)
+{
+	const int D = dec.cfg.decimation, R = D / 4, N = dec.cfg.cicOrder;
+	int64_t integ[PDM_DEC_MAX_ORDER] = {0}, comb[PDM_DEC_MAX_ORDER] = {0};
+	std::vector<double> cic;
+	// Same start as PDM_DEC_Reset(): alternating bits before the first word
+	std::vector<int> bits;
+	for(int k = 0; k < 8 * dec.histBytes; k++) bits.push_back((k & 1) ? 1 : 0);
+	const size_t pre = bits.size();
+	for(uint16_t w : pdm) for(int k = 15; k >= 0; k--) bits.push_back((w >> k) & 1);
+	for(size_t i = 0; i < bits.size(); i++)
+	{
+		int64_t v = bits[i] ? 1 : -1;
+		for(int s = 0; s < N; s++) v = integ[s] += v;
+		if(i < pre || (i - pre) % R != (size_t)R - 1) continue;
+		for(int s = 0; s < N; s++)
+		{
+			const int64_t t = v - comb[s];
+			comb[s] = v;
+			v = t;
+		}
+		cic.push_back((double)v / pow((double)R, (double)N));
+	}
+	// The combs need N outputs of history: the model starts from the first
+	// full group, while the LUT starts with a history of alternating bits.
+	// Both agree once the CIC kernel has filled (skipped below).
+	auto fir = [](const float *h, int L, const std::vector<double> &x, int step) {
+		std::vector<double> y;
+		for(size_t m = 0; m + L <= x.size(); m += step)
+		{
+			double acc = 0.0;
+			for(int k = 0; k < L; k++) acc += h[k] * x[m + k];
+			y.push_back(acc);
+		}
+		return y;
+	};
+	std::vector<double> zeros1(PDM_DEC_HB1_TAPS - 1, 0.0);
+	cic.insert(cic.begin(), zeros1.begin(), zeros1.end());
+	std::vector<double> y1 = fir(dec.hb1, PDM_DEC_HB1_TAPS, cic, 2);
+	y1.insert(y1.begin(), PDM_DEC_HB2_TAPS - 1, 0.0);
+	std::vector<double> y2 = fir(dec.hb2, PDM_DEC_HB2_TAPS, y1, 2);
+	y2.insert(y2.begin(), PDM_DEC_COMP_TAPS - 1, 0.0);
+	std::vector<double> y3 = fir(dec.comp, PDM_DEC_COMP_TAPS, y2, 1);
+	std::vector<int16_t> out(y3.size());
+	for(size_t n = 0; n < y3.size(); n++) out[n] = (int16_t)fmax(-32768.0, fmin(32767.0, floor(y3[n] + 0.5)));
+	return out;
+}
+
+// Overall gain at f Hz relative to the passband gain
+static double chainMagnitude(const PdmDecimator_t &dec, double f, double gain)
+{
+	const int D = dec.cfg.decimation;
+	const double fsOut = FS_PDM / D;
+	return PDM_DEC_FrontMagnitude(&dec, f / FS_PDM) * PDM_DEC_Magnitude(dec.hb1, PDM_DEC_HB1_TAPS, f / (4.0 * fsOut))
+			* PDM_DEC_Magnitude(dec.hb2, PDM_DEC_HB2_TAPS, f / (2.0 * fsOut)) * PDM_DEC_Magnitude(dec.comp, PDM_DEC_COMP_TAPS, f / fsOut) / gain;
+}
+
+static const char *feName[] = {"LUT8", "LUT4", "LUT16"};
+
+static int run(uint16_t D, uint8_t N, uint8_t fe)
+{
+	PdmDecConfig_t cfg = {D, N, 0.0F, fe};
+	static PdmDecimator_t dec;
+	std::vector<int32_t> table(PDM_DEC_TABLE_WORDS(fe, D, N));
+	if(PDM_DEC_Init(&dec, &cfg, table.data())) { printf("init failed\n"); return 1; }
+	const double fsOut = FS_PDM / D, gain = 32768.0;
+	const size_t outPerMs = (size_t)(fsOut / 1000.0);
+
+	// Response of the designed chain
+	double ripple = 0.0, alias = 0.0;
+	for(int g = 0; g <= 200; g++) ripple = fmax(ripple, fabs(20.0 * log10(chainMagnitude(dec, PDM_DEC_PASSBAND * fsOut * g / 200.0, gain))));
+	for(double f = fsOut - PDM_DEC_PASSBAND * fsOut; f < FS_PDM / 2; f += 25.0)
+	{
+		// Folds into the passband?
+		const double r = fmod(f, fsOut);
+		if(r <= PDM_DEC_PASSBAND * fsOut || r >= fsOut - PDM_DEC_PASSBAND * fsOut) alias = fmax(alias, chainMagnitude(dec, f, gain));
+	}
+
+	// Bit exactness against the bit-serial model, blocks of random size
+	const std::vector<uint16_t> pdm = stimulus(0.5, 1000.0, TEST_MS);
+	const size_t total = pdm.size() * 16 / D;
+	std::vector<int16_t> y(total);
+	size_t done = 0;
+	srand(3);
+	while(done < total)
+	{
+		size_t n = 1 + (size_t)rand() % 60;
+		if(n > total - done) n = total - done;
+		PDM_DEC_Process(&dec, &pdm[done * D / 16], &y[done], (uint16_t)n);
+		done += n;
+	}
+	const std::vector<int16_t> ref = reference(dec, pdm);
+	int maxDiff = 0;
+	const size_t skip = 64;		// Filter start-up
+	for(size_t n = skip; n < std::min(total, ref.size()); n++) maxDiff = std::max(maxDiff, abs(y[n] - ref[n]));
+
+	// SINAD: least-squares sine at the known frequency, the rest is noise
+	double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0, mean = 0.0;
+	const size_t n0 = total / 4;
+	for(size_t n = n0; n < total; n++) mean += y[n];
+	mean /= (double)(total - n0);
+	for(size_t n = n0; n < total; n++)
+	{
+		const double s = sin(2.0 * M_PI * 1000.0 * n / fsOut), c = cos(2.0 * M_PI * 1000.0 * n / fsOut);
+		ss += s * s; sc += s * c; cc += c * c; ys += (y[n] - mean) * s; yc += (y[n] - mean) * c;
+	}
+	const double det = ss * cc - sc * sc, a = (ys * cc - yc * sc) / det, b = (yc * ss - ys * sc) / det;
+	double sig = 0.0, err = 0.0;
+	for(size_t n = n0; n < total; n++)
+	{
+		const double fit = a * sin(2.0 * M_PI * 1000.0 * n / fsOut) + b * cos(2.0 * M_PI * 1000.0 * n / fsOut);
+		sig += fit * fit;
+		err += (y[n] - mean - fit) * (y[n] - mean - fit);
+	}
+	const double amp = sqrt(a * a + b * b) / 32768.0;
+
+	// Speed: one 1 ms block at a time, as lab5 calls it
+	std::vector<int16_t> pcm(outPerMs);
+	const size_t ms = 200;
+	const double t = bench::ticksPerItem([&]() {
+		for(size_t k = 0; k < ms; k++) PDM_DEC_Process(&dec, &pdm[k * outPerMs * D / 16], pcm.data(), (uint16_t)outPerMs);
+		bench::doNotOptimize(pcm.data());
+	}, ms);
+
+	const double aliasDb = 20.0 * log10(alias), sinad = 10.0 * log10(sig / err);
+	const bool ok = maxDiff <= 1 && ripple < 0.05 && aliasDb <= MAX_ALIAS_DB && sinad >= MIN_SINAD_DB(D);
+	printf("D %2d N %d %-5s %2d lookups %7zu B | ripple %.3f dB | alias %6.1f dB | model diff %d LSB | amp %.4f | SINAD %5.1f dB | %7.0f %s/ms %s\n",
+			D, N, feName[fe], dec.lookups, table.size() * sizeof(int32_t), ripple, aliasDb, maxDiff, amp,
+			sinad, t, bench::tickUnit(), ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	printf("PDM %.3f MHz -> PCM, 1 kHz at -6 dBFS (amp 0.5):\n", FS_PDM / 1e6);
+	int fails = 0;
+	const uint8_t fes[] = {PDM_DEC_FE_LUT4, PDM_DEC_FE_LUT8, PDM_DEC_FE_LUT16};
+	for(uint16_t D : {32, 64})
+	{
+		for(uint8_t N : {4, 5})
+		{
+			for(uint8_t fe : fes) fails += run(D, N, fe);
+		}
+	}
+	return fails;
+}
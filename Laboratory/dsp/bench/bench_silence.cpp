@@ -0,0 +1,242 @@
+/*
+ * bench_silence.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host benchmark of the silence/denormal fast path (silence.h):
+ *  - decaying tail: a noise burst into a low-cutoff 8th order low-pass, then
+ *    4 s of silence. Without FTZ and without the state flush the tail goes
+ *    through the subnormal range; the cost per sample of the silent part
+ *    with FTZ off/on and flush off/on, and the largest output difference of
+ *    the flushed run against the plain one,
+ *  - silent input into an idle filter: cycles per sample of every filter
+ *    with the fast path, next to the same block of noise,
+ *  - flush threshold 0 (never flush): a state that reaches exact zero by
+ *    itself (an FIR-only section) must still take the fast path,
+ *  - BIQUAD_Q31: bursts and silence through the lab5 high-pass with the fast
+ *    path, against the sample loop with the same flushes (must match: the
+ *    skip is exact) and against the plain sample loop (the flush may move
+ *    the start of the next burst by an LSB).
+ *
+ *  Build: g++ -O2 -std=c++17 bench_silence.cpp -o bench_silence
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include "bench_util.h"
+#include "../iir_design.h"
+#include "../iir_simd.h"
+#include "../iir_q31.h"
+#include "../multichannel.h"
+
+/* Private define ------------------------------------------------------------*/
+#define FS				(48000.0)
+#define BLOCK_SIZE		(256)
+#define TAIL_BLOCKS		(750)		// 4 s of silence
+#define SPEED_BLOCKS	(64)
+
+/* Private function reference -----------------------------------------------*/
+static void setFlushToZero(bool on)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	if(on) DSP_EnableFlushToZero();
+	else _mm_setcsr(_mm_getcsr() & ~0x8040U);
+#else
+	if(on) DSP_EnableFlushToZero();
+#endif
+}
+
+static std::vector<dsp::Biquad> design(dsp::IirType type, int order, double fc)
+{
+	dsp::IirDesignSpec s = {type, dsp::IIR_BUTTERWORTH, order, (float)(2.0 * M_PI * fc / FS), 0.0F, 0.0F, true};
+	std::vector<dsp::Biquad> sos;
+	dsp::iirDesign(s, sos);
+	return sos;
+}
+
+// Burst, then TAIL_BLOCKS silent blocks; returns ticks per silent sample
+static double tail(const std::vector<dsp::Biquad> &sos, bool flush, std::vector<float> &y)
+{
+	const std::vector<float> burst = bench::noise(BLOCK_SIZE, 0.9F);
+	const std::vector<float> zeros(BLOCK_SIZE, 0.0F);
+	dsp::SosCascade f(sos);
+	if(!flush) f.setFlushThreshold(0.0F);
+	y.resize((TAIL_BLOCKS + 1) * BLOCK_SIZE);
+	return bench::ticksPerItem([&]() {
+		f.reset();
+		f.process(burst.data(), y.data(), BLOCK_SIZE);
+		for(size_t b = 1; b <= TAIL_BLOCKS; b++) f.process(zeros.data(), &y[b * BLOCK_SIZE], BLOCK_SIZE);
+		bench::doNotOptimize(y.data());
+	}, TAIL_BLOCKS * BLOCK_SIZE, 3);
+}
+
+static int decay()
+{
+	const std::vector<dsp::Biquad> sos = design(dsp::IIR_LOWPASS, 8, 40.0);
+	std::vector<float> yRef, y;
+	printf("8th order low-pass 40 Hz, burst then %.0f s of silence (%s/silent sample):\n",
+			TAIL_BLOCKS * BLOCK_SIZE / FS, bench::tickUnit());
+	int fails = 0;
+	for(int mode = 0; mode < 4; mode++)
+	{
+		const bool ftz = mode & 1, flush = mode & 2;
+		setFlushToZero(ftz);
+		const double t = tail(sos, flush, mode ? y : yRef);
+		size_t subnormal = 0;
+		float diff = 0.0F;
+		const std::vector<float> &out = mode ? y : yRef;
+		for(size_t n = 0; n < out.size(); n++)
+		{
+			subnormal += out[n] != 0.0F && fabsf(out[n]) < 1.17549435e-38F;
+			if(mode) diff = fmaxf(diff, fabsf(out[n] - yRef[n]));
+		}
+		// Flushing (or FTZ) drops a tail that is already below 1e-12
+		const bool ok = diff < 1e-9F;
+		fails += !ok;
+		printf("    FTZ %-3s flush %-3s %8.2f | subnormal outputs %6zu | max diff %.1e %s\n", ftz ? "on" : "off",
+				flush ? "on" : "off", t, subnormal, (double)diff, ok ? "ok" : "FAIL");
+	}
+	setFlushToZero(false);
+	return fails;
+}
+
+// Ticks per sample on an idle filter fed zeros, and fed noise
+template <typename Fn>
+static void idle(const char *name, Fn fn, size_t samples)
+{
+	const std::vector<float> x = bench::noise(samples);
+	const std::vector<float> zeros(samples, 0.0F);
+	std::vector<float> y(samples);
+	double tNoise = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++) fn(x.data(), y.data());
+		bench::doNotOptimize(y.data());
+	}, SPEED_BLOCKS * samples);
+	double tZero = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++) fn(zeros.data(), y.data());
+		bench::doNotOptimize(y.data());
+	}, SPEED_BLOCKS * samples);
+	printf("    %-28s noise %6.2f | silence %6.3f %s/sample | %5.1fx\n", name, tNoise, tZero, bench::tickUnit(),
+			tNoise / tZero);
+}
+
+static void idleSpeed()
+{
+	printf("idle filter, silent blocks skipped:\n");
+	const std::vector<dsp::Biquad> sos = design(dsp::IIR_LOWPASS, 8, 1000.0);
+	dsp::SosCascade cascade(sos);
+	idle("SosCascade 4 sections", [&](const float *x, float *y) { cascade.process(x, y, BLOCK_SIZE); },
+			BLOCK_SIZE);
+
+	dsp::MultiChannelSos stereo(sos, 2);
+	idle("MultiChannelSos 2 ch", [&](const float *x, float *y) { stereo.process(x, y, BLOCK_SIZE / 2); },
+			BLOCK_SIZE);
+
+	std::vector<float> h(63);
+	for(size_t k = 0; k < h.size(); k++) h[k] = 1.0F / (float)h.size();
+	dsp::MultiChannelFir fir(h.data(), h.size(), 2);
+	idle("MultiChannelFir 63 taps 2 ch", [&](const float *x, float *y) { fir.process(x, y, BLOCK_SIZE / 2); },
+			BLOCK_SIZE);
+
+	printf("    fast blocks: cascade %u/%u, stereo %u/%u, fir %u/%u\n", cascade.silenceStats().fastBlocks,
+			cascade.silenceStats().blocks, stereo.silenceStats().fastBlocks, stereo.silenceStats().blocks,
+			fir.silenceStats().fastBlocks, fir.silenceStats().blocks);
+}
+
+// A noise block, then silence through a section without poles: its state is
+// exactly zero after two silent samples, so every later silent block is skipped
+static int exactZero()
+{
+	const std::vector<dsp::Biquad> sos(1, dsp::Biquad{0.5F, 0.3F, 0.2F, 0.0F, 0.0F});
+	const std::vector<float> burst = bench::noise(BLOCK_SIZE), zeros(BLOCK_SIZE, 0.0F);
+	std::vector<float> y(BLOCK_SIZE);
+	dsp::SosCascade cascade(sos);
+	dsp::MultiChannelSos stereo(sos, 2);
+	cascade.setFlushThreshold(0.0F);
+	stereo.setFlushThreshold(0.0F);
+	cascade.process(burst.data(), y.data(), BLOCK_SIZE);
+	stereo.process(burst.data(), y.data(), BLOCK_SIZE / 2);
+	for(int b = 0; b < 10; b++)
+	{
+		cascade.process(zeros.data(), y.data(), BLOCK_SIZE);
+		stereo.process(zeros.data(), y.data(), BLOCK_SIZE / 2);
+	}
+	const bool ok = cascade.silenceStats().fastBlocks == 9 && stereo.silenceStats().fastBlocks == 9;
+	printf("flush threshold 0, state decayed to exact zero: skipped cascade %u/10, stereo %u/10 %s\n",
+			cascade.silenceStats().fastBlocks, stereo.silenceStats().fastBlocks, ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+static int q31()
+{
+	// lab5 DC blocker: 2nd order high-pass at 20 Hz, 48-sample blocks
+	const std::vector<dsp::Biquad> sos = design(dsp::IIR_HIGHPASS, 2, 20.0);
+	const uint16_t L = 48, blocks = 4000;
+	int32_t coefs[BIQUAD_Q31_COEFS], stFast[BIQUAD_Q31_STATE], stSkip[BIQUAD_Q31_STATE], stRef[BIQUAD_Q31_STATE];
+	BIQUAD_Q31_Quantize(&sos[0].b0, coefs, 1);
+	BiquadQ31_t fast, skip, ref;
+	BIQUAD_Q31_Init(&fast, coefs, stFast, 1);
+	BIQUAD_Q31_Init(&skip, coefs, stSkip, 1);
+	BIQUAD_Q31_Init(&ref, coefs, stRef, 1);
+
+	// Bursts of noise with long silent gaps
+	const std::vector<float> nz = bench::noise((size_t)L * blocks, 0.8F, 7);
+	std::vector<int16_t> x((size_t)L * blocks, 0), yFast(x.size()), ySkip(x.size()), yRef(x.size());
+	for(size_t n = 0; n < x.size(); n++)
+	{
+		if((n / L) % 500 < 20) x[n] = (int16_t)(nz[n] * 32767.0F);
+	}
+	for(size_t b = 0; b < blocks; b++)
+	{
+		const int16_t *in = &x[b * L];
+		BIQUAD_Q31_Process(&fast, in, &yFast[b * L], L, 1, 1);
+		for(uint16_t n = 0; n < L; n++)
+		{
+			ySkip[b * L + n] = BIQUAD_Q31_ProcessSample(&skip, in[n]);
+			yRef[b * L + n] = BIQUAD_Q31_ProcessSample(&ref, in[n]);
+		}
+		if(DSP_IsSilentQ15(in, L, 1, 0)) BIQUAD_Q31_Flush(&skip);
+	}
+	size_t mismatch = 0;
+	int maxDiff = 0;
+	for(size_t n = 0; n < x.size(); n++)
+	{
+		mismatch += yFast[n] != ySkip[n];
+		maxDiff = std::max(maxDiff, abs(yFast[n] - yRef[n]));
+	}
+
+	const std::vector<int16_t> zeros(L, 0);
+	std::vector<int16_t> out(L);
+	BIQUAD_Q31_Reset(&fast);
+	double tZero = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++) BIQUAD_Q31_Process(&fast, zeros.data(), out.data(), L, 1, 1);
+		bench::doNotOptimize(out.data());
+	}, SPEED_BLOCKS * L);
+	double tRef = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			for(uint16_t n = 0; n < L; n++) out[n] = BIQUAD_Q31_ProcessSample(&ref, zeros[n]);
+		}
+		bench::doNotOptimize(out.data());
+	}, SPEED_BLOCKS * L);
+
+	const bool ok = mismatch == 0 && maxDiff <= 1;
+	printf("BIQUAD_Q31 HP 20 Hz: %u of %u blocks skipped, %u flushes | mismatches %zu | vs no flush %d LSB %s\n",
+			fast.stats.fastBlocks, fast.stats.blocks, fast.stats.flushes, mismatch, maxDiff, ok ? "ok" : "FAIL");
+	printf("    silence %6.3f %s/sample, without the fast path %6.2f\n", tZero, bench::tickUnit(), tRef);
+	return ok ? 0 : 1;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	int fails = decay();
+	idleSpeed();
+	fails += exactZero();
+	fails += q31();
+	return fails;
+}
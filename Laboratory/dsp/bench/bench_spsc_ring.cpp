@@ -0,0 +1,340 @@
+/*
+ * bench_spsc_ring.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Host check of the lab5 PCM FIFO replacement (spsc_ring.h):
+ *  - stress: a producer thread writes a numbered sample stream in blocks and
+ *    single samples of varying size into a small ring, a consumer thread
+ *    reads it back the same way; every sample must arrive once and in order
+ *    across many wraps of the buffer and of the 16-bit numbers; once with
+ *    block copies, once in place with reserve/commit and peek/consume
+ *    (committing and consuming only part of the spans now and then),
+ *  - throughput: cycles per sample of lab5's traffic (48-sample blocks in,
+ *    the TX side taking one sample at a time or a block) for Fifo_t and for
+ *    the ring,
+ *  - lab5's loop on the ring: decode into uPcmBuffer, write the block, read
+ *    per sample into the stereo DMA half, against decoding into the
+ *    reserved span and duplicating from the peeked one,
+ *  - TX transfer: a stereo DMA half filled with SPSC_ReadStereo() against
+ *    the per-sample loop and the per-sample loop over the peeked spans; the
+ *    word-wide and SSE2 duplication must match the scalar one for every
+ *    length and alignment.
+ *
+ *  Build: g++ -O2 -std=c++17 -pthread bench_spsc_ring.cpp -o bench_spsc_ring
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "../spsc_ring.h"
+#include "../../lab5 - PDM a PCM/fifo.c"
+
+/* Private define ------------------------------------------------------------*/
+#define STRESS_SAMPLES	(20000000UL)
+#define STRESS_CAPACITY	(64)
+#define FIFO_SIZE		(512)		// lab5 AUDIO_PCM_FIFO_SIZE
+#define BLOCK			(48)		// lab5 AUDIO_NUM_OUT_SAMPLES
+#define SPEED_BLOCKS	(4096)
+
+/* Private function reference -----------------------------------------------*/
+// Producer side of the stress test, in place: a random part of the spans
+static uint32_t produceInPlace(SpscRing_t *pRing, unsigned long seq, uint32_t want, unsigned long r)
+{
+	SpscSpan_t span;
+	uint32_t n = SPSC_Reserve(pRing, want, &span);
+	if(n && (r & 0x300) == 0) n = (uint32_t)(r >> 12) % n;	// Commit less than reserved
+	for(uint32_t k = 0, i = 0; k < 2; k++)
+	{
+		for(uint32_t j = 0; j < span.len[k] && i < n; j++, i++) span.data[k][j] = (int16_t)(seq + i);
+	}
+	SPSC_Commit(pRing, n);
+	return n;
+}
+
+static uint32_t consumeInPlace(SpscRing_t *pRing, unsigned long seq, uint32_t want, unsigned long r, unsigned long *pErrors)
+{
+	SpscSpan_t span;
+	uint32_t n = SPSC_Peek(pRing, want, &span);
+	if(n && (r & 0x300) == 0) n = (uint32_t)(r >> 12) % n;
+	for(uint32_t k = 0, i = 0; k < 2; k++)
+	{
+		for(uint32_t j = 0; j < span.len[k] && i < n; j++, i++) *pErrors += span.data[k][j] != (int16_t)(seq + i);
+	}
+	SPSC_Consume(pRing, n);
+	return n;
+}
+
+static int stress(bool inPlace)
+{
+	std::vector<int16_t> mem(STRESS_CAPACITY);
+	SpscRing_t ring;
+	SPSC_Init(&ring, mem.data(), STRESS_CAPACITY);
+	std::atomic<bool> done(false);
+
+	std::thread producer([&]() {
+		int16_t blk[STRESS_CAPACITY + 8];
+		unsigned long seq = 0, r = 1;
+		while(seq < STRESS_SAMPLES)
+		{
+			r = r * 1103515245UL + 12345UL;
+			const uint32_t want = (uint32_t)(r >> 16) % (STRESS_CAPACITY + 8);
+			if(inPlace)
+			{
+				seq += produceInPlace(&ring, seq, (uint32_t)std::min<unsigned long>(want, STRESS_SAMPLES - seq), r);
+				if(SPSC_Space(&ring) == 0) std::this_thread::yield();
+			}
+			else if(want & 1)
+			{
+				// Block write, may be cut short by a full ring
+				uint32_t n = 0;
+				for(; n < want && seq + n < STRESS_SAMPLES; n++) blk[n] = (int16_t)(seq + n);
+				seq += SPSC_WriteBlock(&ring, blk, n);
+			}
+			else if(SPSC_Write(&ring, (int16_t)seq) == 0)
+			{
+				seq++;
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+		done.store(true);
+	});
+
+	unsigned long seq = 0, errors = 0, r = 7;
+	int16_t blk[STRESS_CAPACITY + 8];
+	for(;;)
+	{
+		const bool finished = done.load();
+		r = r * 1103515245UL + 12345UL;
+		const uint32_t want = (uint32_t)(r >> 16) % (STRESS_CAPACITY + 8);
+		uint32_t got;
+		if(inPlace)
+		{
+			got = consumeInPlace(&ring, seq, want, r, &errors);
+			seq += got;
+		}
+		else
+		{
+			got = (want & 1) ? SPSC_ReadBlock(&ring, blk, want) : (uint32_t)(SPSC_Read(&ring, blk) == 0);
+			for(uint32_t n = 0; n < got; n++, seq++) errors += blk[n] != (int16_t)seq;
+		}
+		if(!got)
+		{
+			if(finished && !SPSC_Count(&ring)) break;
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	const bool ok = !errors && seq == STRESS_SAMPLES;
+	printf("stress (%s): %lu samples through a %d-sample ring | out of order %lu | received %lu %s\n",
+			inPlace ? "in place" : "copies", STRESS_SAMPLES, STRESS_CAPACITY, errors, seq, ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+static void speed()
+{
+	std::vector<int16_t> in(BLOCK), out(BLOCK), mem(FIFO_SIZE);
+	for(size_t n = 0; n < BLOCK; n++) in[n] = (int16_t)n;
+	Fifo_t fifo;
+	SpscRing_t ring;
+	FIFO_Init(&fifo, mem.data(), FIFO_SIZE);
+	SPSC_Init(&ring, mem.data(), FIFO_SIZE);
+
+	// Keep the FIFOs half full so the copies wrap now and then
+	FIFO_WriteBlock(&fifo, mem.data(), FIFO_SIZE / 2);
+	SPSC_WriteBlock(&ring, mem.data(), FIFO_SIZE / 2);
+
+	const double tFifoBlock = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			FIFO_WriteBlock(&fifo, in.data(), BLOCK);
+			FIFO_ReadBlock(&fifo, out.data(), BLOCK);
+		}
+		bench::doNotOptimize(out.data());
+	}, SPEED_BLOCKS * BLOCK);
+	const double tRingBlock = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			SPSC_WriteBlock(&ring, in.data(), BLOCK);
+			SPSC_ReadBlock(&ring, out.data(), BLOCK);
+		}
+		bench::doNotOptimize(out.data());
+	}, SPEED_BLOCKS * BLOCK);
+	const double tFifoSample = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			FIFO_WriteBlock(&fifo, in.data(), BLOCK);
+			for(size_t n = 0; n < BLOCK; n++) FIFO_Read(&fifo, &out[n]);
+		}
+		bench::doNotOptimize(out.data());
+	}, SPEED_BLOCKS * BLOCK);
+	const double tRingSample = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			SPSC_WriteBlock(&ring, in.data(), BLOCK);
+			for(size_t n = 0; n < BLOCK; n++) SPSC_Read(&ring, &out[n]);
+		}
+		bench::doNotOptimize(out.data());
+	}, SPEED_BLOCKS * BLOCK);
+
+	printf("%d-sample blocks through a %d-sample FIFO (%s/sample, write + read):\n", BLOCK, FIFO_SIZE, bench::tickUnit());
+	printf("    block in, block out  | Fifo_t %6.2f | SpscRing_t %6.2f | %5.1fx\n", tFifoBlock, tRingBlock,
+			tFifoBlock / tRingBlock);
+	printf("    block in, sample out | Fifo_t %6.2f | SpscRing_t %6.2f | %5.1fx\n", tFifoSample, tRingSample,
+			tFifoSample / tRingSample);
+}
+
+// Stands in for PDM_Filter + AudioProcessCallback writing a block
+static void decode(int16_t *pcm, uint32_t len, int16_t seed)
+{
+	for(uint32_t n = 0; n < len; n++) pcm[n] = (int16_t)(seed + 3 * (int16_t)n);
+}
+
+static void lab5Loop()
+{
+	std::vector<int16_t> pcm(BLOCK), dma(4 * BLOCK), mem(FIFO_SIZE);
+	SpscRing_t ring;
+
+	// Copies: decode into uPcmBuffer, write block, read per sample
+	SPSC_Init(&ring, mem.data(), FIFO_SIZE);
+	const double tCopy = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			decode(pcm.data(), BLOCK, (int16_t)b);
+			SPSC_WriteBlock(&ring, pcm.data(), BLOCK);
+			int16_t *half = &dma[(b & 1) * 2 * BLOCK];
+			for(size_t n = 0; n < BLOCK; n++)
+			{
+				int16_t v = 0;
+				SPSC_Read(&ring, &v);
+				half[2 * n] = half[2 * n + 1] = v;
+			}
+		}
+		bench::doNotOptimize(dma.data());
+	}, SPEED_BLOCKS * BLOCK);
+
+	// In place: decode into the reserved span (uPcmBuffer when it wraps),
+	// duplicate from the peeked spans
+	SPSC_Init(&ring, mem.data(), FIFO_SIZE);
+	unsigned long wrapped = 0;
+	const double tInPlace = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			SpscSpan_t span;
+			SPSC_Reserve(&ring, BLOCK, &span);
+			if(span.len[0] == BLOCK)
+			{
+				decode(span.data[0], BLOCK, (int16_t)b);
+				SPSC_Commit(&ring, BLOCK);
+			}
+			else
+			{
+				decode(pcm.data(), BLOCK, (int16_t)b);
+				SPSC_WriteBlock(&ring, pcm.data(), BLOCK);
+				wrapped++;
+			}
+			int16_t *half = &dma[(b & 1) * 2 * BLOCK];
+			const uint32_t len = SPSC_Peek(&ring, BLOCK, &span);
+			for(uint32_t k = 0, i = 0; k < 2; k++)
+			{
+				for(uint32_t n = 0; n < span.len[k]; n++, i += 2) half[i] = half[i + 1] = span.data[k][n];
+			}
+			SPSC_Consume(&ring, len);
+		}
+		bench::doNotOptimize(dma.data());
+	}, SPEED_BLOCKS * BLOCK);
+
+	printf("lab5 loop, decode + FIFO + stereo DMA half (%s/sample):\n", bench::tickUnit());
+	printf("    copies %6.2f | in place %6.2f | %5.1fx (%.1f%% of the blocks wrapped)\n", tCopy, tInPlace,
+			tCopy / tInPlace, 100.0 * (double)wrapped / (5.0 * SPEED_BLOCKS));
+}
+
+static int txTransfer()
+{
+	// Duplication against the scalar loop, every length and misalignment
+	std::vector<int16_t> in(80), ref(2 * 80), out(2 * 80 + 2);
+	for(size_t n = 0; n < in.size(); n++) in[n] = (int16_t)(n * 2654435761UL >> 7);
+	unsigned long bad = 0;
+	for(uint32_t len = 0; len <= 64; len++)
+	{
+		for(uint32_t off = 0; off < 4; off++)
+		{
+			for(uint32_t n = 0; n < len; n++) ref[2 * n] = ref[2 * n + 1] = in[off + n];
+			SPSC_DupStereo(&in[off], &out[1], len);
+			for(uint32_t n = 0; n < 2 * len; n++) bad += out[1 + n] != ref[n];
+			SPSC_DupStereoWord(&in[off], &out[0], len);
+			for(uint32_t n = 0; n < 2 * len; n++) bad += out[n] != ref[n];
+		}
+	}
+
+	// lab5: 48 frames per DMA half, the FIFO at its usual fill level
+	std::vector<int16_t> dma(4 * BLOCK), dmaRef(4 * BLOCK), mem(FIFO_SIZE), pcm(BLOCK);
+	SpscRing_t ring;
+	SPSC_Init(&ring, mem.data(), FIFO_SIZE);
+	for(size_t n = 0; n < BLOCK; n++) pcm[n] = (int16_t)(n * 977);
+	SPSC_WriteBlock(&ring, pcm.data(), BLOCK);
+	const double tSample = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			SPSC_WriteBlock(&ring, pcm.data(), BLOCK);
+			int16_t *half = &dmaRef[(b & 1) * 2 * BLOCK];
+			for(size_t n = 0; n < BLOCK; n++)
+			{
+				int16_t v = 0;
+				SPSC_Read(&ring, &v);
+				half[2 * n] = half[2 * n + 1] = v;
+			}
+		}
+		bench::doNotOptimize(dmaRef.data());
+	}, SPEED_BLOCKS * BLOCK);
+	const double tSpans = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			SPSC_WriteBlock(&ring, pcm.data(), BLOCK);
+			int16_t *half = &dma[(b & 1) * 2 * BLOCK];
+			SpscSpan_t span;
+			const uint32_t len = SPSC_Peek(&ring, BLOCK, &span);
+			for(uint32_t k = 0, i = 0; k < 2; k++)
+			{
+				for(uint32_t n = 0; n < span.len[k]; n++, i += 2) half[i] = half[i + 1] = span.data[k][n];
+			}
+			SPSC_Consume(&ring, len);
+		}
+		bench::doNotOptimize(dma.data());
+	}, SPEED_BLOCKS * BLOCK);
+	const double tStereo = bench::ticksPerItem([&]() {
+		for(size_t b = 0; b < SPEED_BLOCKS; b++)
+		{
+			SPSC_WriteBlock(&ring, pcm.data(), BLOCK);
+			SPSC_ReadStereo(&ring, &dma[(b & 1) * 2 * BLOCK], BLOCK);
+		}
+		bench::doNotOptimize(dma.data());
+	}, SPEED_BLOCKS * BLOCK);
+	for(size_t n = 0; n < dma.size(); n++) bad += dma[n] != dmaRef[n];
+
+	const bool ok = !bad;
+	printf("TX DMA half, %d frames (%s/frame incl. the block write): per sample %5.2f | spans %5.2f | "
+			"SPSC_ReadStereo %5.2f | mismatches %lu %s\n", BLOCK, bench::tickUnit(), tSample, tSpans, tStereo, bad,
+			ok ? "ok" : "FAIL");
+	return ok ? 0 : 1;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main()
+{
+	int fails = stress(false);
+	fails += stress(true);
+	speed();
+	lab5Loop();
+	fails += txTransfer();
+	return fails;
+}
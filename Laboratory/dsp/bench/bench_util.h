@@ -0,0 +1,87 @@
+/*
+ * bench_util.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Timing helpers for the host benchmarks in this folder.
+ */
+
+#ifndef DSP_BENCH_UTIL_H_
+#define DSP_BENCH_UTIL_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+/* Exported function prototypes -----------------------------------------------*/
+// Cycle counter on x86 (TSC), nanoseconds elsewhere
+inline uint64_t ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline const char *tickUnit()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return "cycles";
+#else
+	return "ns";
+#endif
+}
+
+inline double seconds()
+{
+	return std::chrono::duration<double>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Uniform white noise in [-amp, amp], deterministic across runs
+inline std::vector<float> noise(size_t len, float amp = 0.5F, unsigned seed = 1)
+{
+	std::vector<float> x(len);
+	srand(seed);
+	for(size_t n = 0; n < len; n++)
+	{
+		x[n] = amp * (2.0F * (float)rand() / (float)RAND_MAX - 1.0F);
+	}
+	return x;
+}
+
+// Best of reps runs of fn(), returned in ticks per item
+template <typename Fn>
+double ticksPerItem(Fn fn, size_t items, int reps = 5)
+{
+	double best = 1e300;
+	for(int r = 0; r < reps; r++)
+	{
+		uint64_t t0 = ticks();
+		fn();
+		uint64_t t1 = ticks();
+		double t = (double)(t1 - t0) / (double)items;
+		if(t < best) best = t;
+	}
+	return best;
+}
+
+// Keeps the optimizer from discarding benchmark results
+inline void doNotOptimize(const void *p)
+{
+	__asm__ __volatile__("" : : "g"(p) : "memory");
+}
+
+} // namespace bench
+
+#endif /* DSP_BENCH_UTIL_H_ */
@@ -0,0 +1,90 @@
+/*
+ * coef_file.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Loads coefficient arrays from the C snippets the MATLAB scripts print and
+ *  that get pasted into the sketches, e.g. Laboratory/Lab10/coefs:
+ *    const int IIR_ORDER = 2;
+ *    const float a_coefs[] = {-0.9428..., 0.3333...};
+ *  so the host tools use exactly the numbers that go to the device.
+ */
+
+#ifndef DSP_COEF_FILE_H_
+#define DSP_COEF_FILE_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+
+namespace dsp {
+
+/* Exported function prototypes -----------------------------------------------*/
+inline bool readTextFile(const char *path, std::string &text)
+{
+	FILE *fp = fopen(path, "rb");
+	if(!fp) return false;
+	char buf[4096];
+	size_t n;
+	text.clear();
+	while((n = fread(buf, 1, sizeof(buf), fp)) > 0) text.append(buf, n);
+	fclose(fp);
+	return true;
+}
+
+/*
+ * Parses the braces initializer of array name (the first array in the text
+ * when name is nullptr). Values may be separated by commas, tabs or spaces.
+ */
+inline bool parseCoefArray(const std::string &text, const char *name, std::vector<float> &coefs)
+{
+	size_t pos = 0;
+	if(name)
+	{
+		// Match the whole identifier: "a_coefs" must not hit "iir_a_coefs"
+		const size_t len = strlen(name);
+		for(pos = text.find(name); pos != std::string::npos; pos = text.find(name, pos + 1))
+		{
+			char before = pos ? text[pos - 1] : ' ';
+			char after = pos + len < text.size() ? text[pos + len] : ' ';
+			if(!(isalnum((unsigned char)before) || before == '_') && !(isalnum((unsigned char)after) || after == '_')) break;
+		}
+		if(pos == std::string::npos) return false;
+	}
+
+	size_t open = text.find('{', pos);
+	size_t close = text.find('}', open);
+	if(open == std::string::npos || close == std::string::npos) return false;
+
+	coefs.clear();
+	const char *p = text.c_str() + open + 1;
+	const char *end = text.c_str() + close;
+	while(p < end)
+	{
+		char *next;
+		double v = strtod(p, &next);
+		if(next == p)
+		{
+			p++;
+			continue;
+		}
+		coefs.push_back((float)v);
+		p = next;
+	}
+	return !coefs.empty();
+}
+
+inline bool loadCoefArray(const char *path, const char *name, std::vector<float> &coefs)
+{
+	std::string text;
+	return readTextFile(path, text) && parseCoefArray(text, name, coefs);
+}
+
+} // namespace dsp
+
+#endif /* DSP_COEF_FILE_H_ */
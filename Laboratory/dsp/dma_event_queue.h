@@ -0,0 +1,153 @@
+/*
+ * dma_event_queue.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Queue of DMA half/full transfer events from the ISRs to the main loop,
+ *  the replacement of lab5's single-byte state flags (a flag set again
+ *  before the loop read it lost the first event without a trace). Plain C,
+ *  static inline.
+ *  - Several producers (one ISR per DMA stream, possibly at different
+ *    priorities), one consumer (the main loop). A producer claims a slot by
+ *    compare-and-swap on head (LDREX/STREX on the M4) and publishes it by
+ *    storing the slot's turn with release; the consumer takes the slot when
+ *    its turn says it is full. An ISR preempted between the two only delays
+ *    the consumer, events still come out in the order they were claimed.
+ *  - Every event carries the sequence number of its source (DMA halves
+ *    completed on that stream). The consumer counts the gaps as missed: the
+ *    ISR found the queue full and dropped the event (dropped, counted at
+ *    once by the ISR).
+ *  - late: when the consumer takes an event its source has already posted
+ *    the next one, so the DMA is back in the half the event is about (RX:
+ *    overwriting it, TX: sending it). The data is handled anyway, late only
+ *    reports it.
+ *  - DMA_EVQ_Empty() is the check before sleeping: with interrupts masked
+ *    (PRIMASK) an interrupt still ends WFI, so nothing posted between the
+ *    check and the WFI is slept through.
+ */
+
+#ifndef DSP_DMA_EVENT_QUEUE_H_
+#define DSP_DMA_EVENT_QUEUE_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported define ------------------------------------------------------------*/
+#define DMA_EVQ_SIZE		(16)	// Slots, power of two
+#define DMA_EVQ_SOURCES		(4)		// DMA streams (source ids 0 .. 3)
+
+/* Exported typedef -----------------------------------------------------------*/
+typedef struct
+{
+	uint8_t source;		// Stream id, < DMA_EVQ_SOURCES
+	uint8_t half;		// 0: first half done, 1: second half (transfer complete)
+	uint32_t seq;		// Events posted by this source before this one
+} DmaEvent_t;
+
+typedef struct
+{
+	uint32_t turn;		// pos + 1 once full, pos + DMA_EVQ_SIZE once free again
+	DmaEvent_t ev;
+} DmaEvqSlot_t;
+
+typedef struct
+{
+	DmaEvqSlot_t slot[DMA_EVQ_SIZE];
+	uint32_t head;							// Slots claimed, by any producer (CAS)
+	uint32_t tail;							// Slots taken, by the consumer only
+	uint32_t posted[DMA_EVQ_SOURCES];		// Events per source, stored by its ISR only
+	uint32_t dropped[DMA_EVQ_SOURCES];		// Queue full, stored by the ISR only
+	uint32_t expected[DMA_EVQ_SOURCES];		// Next sequence number, consumer only
+	uint32_t missed[DMA_EVQ_SOURCES];		// Sequence gaps seen, consumer only
+	uint32_t late[DMA_EVQ_SOURCES];			// Taken after the next event of the source, consumer only
+} DmaEventQueue_t;
+
+/* Exported function prototypes -----------------------------------------------*/
+// Call before the DMA (the ISRs) starts
+static inline void DMA_EVQ_Init(DmaEventQueue_t *pQ)
+{
+	memset(pQ, 0, sizeof(*pQ));
+	for(uint32_t i = 0; i < DMA_EVQ_SIZE; i++) pQ->slot[i].turn = i;
+}
+
+/*
+ * Producer (ISR): queues the event of source, half. Returns 0, or -1 if the
+ * queue is full (the event is dropped and shows up as a sequence gap).
+ */
+static inline int DMA_EVQ_Post(DmaEventQueue_t *pQ, uint8_t source, uint8_t half)
+{
+	const uint32_t seq = pQ->posted[source];
+	__atomic_store_n(&pQ->posted[source], seq + 1, __ATOMIC_RELEASE);
+	uint32_t pos = __atomic_load_n(&pQ->head, __ATOMIC_RELAXED);
+	for(;;)
+	{
+		DmaEvqSlot_t *pSlot = &pQ->slot[pos & (DMA_EVQ_SIZE - 1)];
+		const int32_t diff = (int32_t)(__atomic_load_n(&pSlot->turn, __ATOMIC_ACQUIRE) - pos);
+		if(diff == 0)
+		{
+			// Free for this pos: claim it (a failed CAS reloads pos)
+			if(__atomic_compare_exchange_n(&pQ->head, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			{
+				pSlot->ev.source = source;
+				pSlot->ev.half = half;
+				pSlot->ev.seq = seq;
+				__atomic_store_n(&pSlot->turn, pos + 1, __ATOMIC_RELEASE);
+				return 0;
+			}
+		}
+		else if(diff < 0)
+		{
+			// Still holds the event of pos - DMA_EVQ_SIZE: full
+			__atomic_store_n(&pQ->dropped[source], pQ->dropped[source] + 1, __ATOMIC_RELAXED);
+			return -1;
+		}
+		else pos = __atomic_load_n(&pQ->head, __ATOMIC_RELAXED);	// Claimed by a preempting producer
+	}
+}
+
+// Consumer: 1 if no event is ready
+static inline int DMA_EVQ_Empty(const DmaEventQueue_t *pQ)
+{
+	return __atomic_load_n(&pQ->slot[pQ->tail & (DMA_EVQ_SIZE - 1)].turn, __ATOMIC_ACQUIRE) != pQ->tail + 1;
+}
+
+/*
+ * Consumer: the oldest event into pEv, returns 1, or 0 if there is none.
+ * Updates the missed and late counters of its source.
+ */
+static inline int DMA_EVQ_Pop(DmaEventQueue_t *pQ, DmaEvent_t *pEv)
+{
+	const uint32_t tail = pQ->tail;
+	DmaEvqSlot_t *pSlot = &pQ->slot[tail & (DMA_EVQ_SIZE - 1)];
+	if(__atomic_load_n(&pSlot->turn, __ATOMIC_ACQUIRE) != tail + 1) return 0;
+	*pEv = pSlot->ev;
+	__atomic_store_n(&pSlot->turn, tail + DMA_EVQ_SIZE, __ATOMIC_RELEASE);
+	pQ->tail = tail + 1;
+
+	const uint8_t src = pEv->source;
+	pQ->missed[src] += pEv->seq - pQ->expected[src];
+	pQ->expected[src] = pEv->seq + 1;
+	if(__atomic_load_n(&pQ->posted[src], __ATOMIC_ACQUIRE) - pEv->seq > 1) pQ->late[src]++;
+	return 1;
+}
+
+// Consumer: missed + late blocks of every source so far (0 while all is well)
+static inline uint32_t DMA_EVQ_Overruns(const DmaEventQueue_t *pQ)
+{
+	uint32_t sum = 0;
+	for(int s = 0; s < DMA_EVQ_SOURCES; s++) sum += pQ->missed[s] + pQ->late[s];
+	return sum;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_DMA_EVENT_QUEUE_H_ */
@@ -0,0 +1,178 @@
+/*
+ * fft.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  In-tree FFT for the block convolvers: iterative radix-2 complex FFT and a
+ *  real FFT of length N computed with one complex FFT of length N/2 plus a
+ *  split step. Twiddles and the bit-reversal table are built once per size.
+ */
+
+#ifndef DSP_FFT_H_
+#define DSP_FFT_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <math.h>
+#include <complex>
+#include <vector>
+
+namespace dsp {
+
+/* Exported typedef -----------------------------------------------------------*/
+typedef std::complex<float> cfloat;
+
+/* Exported function prototypes -----------------------------------------------*/
+inline bool isPow2(size_t n) { return n && !(n & (n - 1)); }
+
+inline size_t nextPow2(size_t n)
+{
+	size_t p = 1;
+	while(p < n) p <<= 1;
+	return p;
+}
+
+/* Exported class -------------------------------------------------------------*/
+// In-place complex FFT of a power-of-two length
+class ComplexFft
+{
+public:
+	ComplexFft() {}
+	explicit ComplexFft(size_t n) { init(n); }
+
+	void init(size_t n)
+	{
+		n_ = n;
+		rev_.assign(n, 0);
+		size_t bits = 0;
+		while(((size_t)1 << bits) < n) bits++;
+		for(size_t i = 0; i < n; i++)
+		{
+			size_t r = 0;
+			for(size_t b = 0; b < bits; b++) r |= ((i >> b) & 1) << (bits - 1 - b);
+			rev_[i] = r;
+		}
+		tw_.resize(n / 2);
+		for(size_t k = 0; k < n / 2; k++)
+		{
+			double a = -2.0 * M_PI * (double)k / (double)n;
+			tw_[k] = cfloat((float)cos(a), (float)sin(a));
+		}
+	}
+
+	size_t size() const { return n_; }
+
+	// X[k] = sum x[n] e^{-j2pi kn/N}; inverse uses e^{+j..} and is not scaled
+	void transform(cfloat *x, bool inverse) const
+	{
+		for(size_t i = 0; i < n_; i++)
+		{
+			if(i < rev_[i]) std::swap(x[i], x[rev_[i]]);
+		}
+		for(size_t len = 2; len <= n_; len <<= 1)
+		{
+			const size_t half = len / 2, step = n_ / len;
+			for(size_t i = 0; i < n_; i += len)
+			{
+				for(size_t k = 0; k < half; k++)
+				{
+					cfloat w = inverse ? std::conj(tw_[k * step]) : tw_[k * step];
+					cfloat a = x[i + k];
+					cfloat b = mul(x[i + k + half], w);
+					x[i + k] = a + b;
+					x[i + k + half] = a - b;
+				}
+			}
+		}
+	}
+
+	// Plain complex multiply, std::complex operator* adds NaN/Inf checks
+	static cfloat mul(cfloat a, cfloat b)
+	{
+		return cfloat(a.real() * b.real() - a.imag() * b.imag(),
+				a.real() * b.imag() + a.imag() * b.real());
+	}
+
+private:
+	size_t n_ = 0;
+	std::vector<size_t> rev_;
+	std::vector<cfloat> tw_;
+};
+
+/*
+ * Real FFT of length N (power of two, N >= 4). forward() fills the N/2+1
+ * non-redundant bins; inverse() takes them back and scales by 1/N, so
+ * inverse(forward(x)) == x.
+ */
+class RealFft
+{
+public:
+	RealFft() {}
+	explicit RealFft(size_t n) { init(n); }
+
+	void init(size_t n)
+	{
+		n_ = n;
+		fft_.init(n / 2);
+		work_.resize(n / 2);
+		split_.resize(n / 2 + 1);
+		for(size_t k = 0; k <= n / 2; k++)
+		{
+			double a = -2.0 * M_PI * (double)k / (double)n;
+			split_[k] = cfloat((float)cos(a), (float)sin(a));
+		}
+	}
+
+	size_t size() const { return n_; }
+
+	void forward(const float *x, cfloat *X)
+	{
+		const size_t h = n_ / 2;
+		cfloat *z = work_.data();
+		for(size_t k = 0; k < h; k++) z[k] = cfloat(x[2 * k], x[2 * k + 1]);
+		fft_.transform(z, false);
+
+		// X[k] = Fe[k] + W^k Fo[k], Fe/Fo are the spectra of the even/odd samples
+		for(size_t k = 0; k <= h; k++)
+		{
+			cfloat a = z[k == h ? 0 : k];
+			cfloat b = std::conj(z[k == 0 ? 0 : h - k]);
+			cfloat fe = 0.5F * (a + b);
+			cfloat fo = cfloat(0.0F, -0.5F) * (a - b);
+			X[k] = fe + ComplexFft::mul(split_[k], fo);
+		}
+	}
+
+	void inverse(const cfloat *X, float *x)
+	{
+		const size_t h = n_ / 2;
+		cfloat *z = work_.data();
+		for(size_t k = 0; k < h; k++)
+		{
+			cfloat a = X[k];
+			cfloat b = std::conj(X[h - k]);
+			cfloat fe = 0.5F * (a + b);
+			cfloat fo = ComplexFft::mul(0.5F * (a - b), std::conj(split_[k]));
+			z[k] = fe + cfloat(-fo.imag(), fo.real());	// Fe + j*Fo
+		}
+		fft_.transform(z, true);
+
+		const float scale = 1.0F / (float)h;
+		for(size_t k = 0; k < h; k++)
+		{
+			x[2 * k] = z[k].real() * scale;
+			x[2 * k + 1] = z[k].imag() * scale;
+		}
+	}
+
+private:
+	size_t n_ = 0;
+	ComplexFft fft_;
+	std::vector<cfloat> work_;	// N/2 point complex buffer
+	std::vector<cfloat> split_;	// W^k = e^{-j2pi k/N}, k = 0..N/2
+};
+
+} // namespace dsp
+
+#endif /* DSP_FFT_H_ */
@@ -0,0 +1,178 @@
+/*
+ * fir.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Block FIR engine shared by the ESP32 sketches and the host tools.
+ *  Header only, so a sketch can pull it with #include "../dsp/fir.h".
+ */
+
+#ifndef DSP_FIR_H_
+#define DSP_FIR_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/* Exported define ------------------------------------------------------------*/
+#define DSP_INT16_SCALE		(32767.0F)	// Full scale used by the AudioKit sketches
+#define DSP_FIR_ACCUMULATORS	(4)			// Independent partial sums per dot product
+
+namespace dsp {
+
+/* Exported function prototypes -----------------------------------------------*/
+// int16 <-> float conversion, same scaling as TOFLOAT/TOINT16 in Lab9
+inline float toFloat(int16_t x) { return (float)x / DSP_INT16_SCALE; }
+
+inline int16_t toInt16(float y)
+{
+	// Audio clipping keeps audio between [-1,1]
+	y = y > 1.0F ? 1.0F : (y < -1.0F ? -1.0F : y);
+	return (int16_t)(y * DSP_INT16_SCALE);
+}
+
+/* Exported typedef -----------------------------------------------------------*/
+enum FirStructure
+{
+	FIR_AUTO = 0,	// Folded when h[k] == h[M-1-k] for every k, direct otherwise
+	FIR_DIRECT,		// One multiply per tap
+	FIR_SYMMETRIC	// Linear phase: pre-add mirrored samples, ceil(M/2) multiplies
+};
+
+/* Exported class -------------------------------------------------------------*/
+/*
+ * FIR filter with a double-length (mirrored) delay line.
+ *
+ * Each input sample is written twice, at state[pos] and state[pos + M], and
+ * pos walks backwards. The window state[pos .. pos + M - 1] always holds
+ *   x[n], x[n-1], ..., x[n-M+1]
+ * contiguously, so the delay line is never shifted and every output is a
+ * single dot product against h[0..M-1].
+ *
+ * Linear-phase (symmetric) filters are folded: the two samples that share a
+ * coefficient are added first,
+ *   y[n] = sum_{k<M/2} h[k]*(x[n-k] + x[n-M+1+k])  (+ h[c]*x[n-c] if M is odd)
+ * which halves the multiplies for odd and even lengths alike.
+ *
+ * The dot products keep DSP_FIR_ACCUMULATORS partial sums, so consecutive
+ * multiply-adds do not wait for each other (a single running sum is bound
+ * by the add latency, not by the multiplier). The summation order differs
+ * from a plain loop by float rounding only.
+ */
+class FirFilter
+{
+public:
+	FirFilter() {}
+	FirFilter(const float *h, size_t numTaps, FirStructure structure = FIR_AUTO) { setCoefs(h, numTaps, structure); }
+
+	// Copy the impulse response h[0..numTaps-1] and clear the delay line
+	void setCoefs(const float *h, size_t numTaps, FirStructure structure = FIR_AUTO)
+	{
+		h_.assign(h, h + numTaps);
+		state_.assign(2 * numTaps, 0.0F);
+		pos_ = 0;
+
+		if(structure == FIR_AUTO)
+		{
+			structure = isSymmetric(h, numTaps) ? FIR_SYMMETRIC : FIR_DIRECT;
+		}
+		// Folding with asymmetric taps would silently change the response
+		symmetric_ = (structure == FIR_SYMMETRIC) && isSymmetric(h, numTaps);
+	}
+
+	static bool isSymmetric(const float *h, size_t numTaps)
+	{
+		for(size_t k = 0; k < numTaps / 2; k++)
+		{
+			if(h[k] != h[numTaps - 1 - k]) return false;
+		}
+		return numTaps > 1;
+	}
+
+	// Clear the delay line, the coefficients are kept
+	void reset()
+	{
+		state_.assign(state_.size(), 0.0F);
+		pos_ = 0;
+	}
+
+	size_t numTaps() const { return h_.size(); }
+	const float *coefs() const { return h_.data(); }
+	FirStructure structure() const { return symmetric_ ? FIR_SYMMETRIC : FIR_DIRECT; }
+
+	// y[n] = x[n]*h[0] + x[n-1]*h[1] + ... + x[n-M+1]*h[M-1]
+	float process(float x)
+	{
+		const size_t M = h_.size();
+		if(!M) return x;
+
+		pos_ = (pos_ == 0) ? M - 1 : pos_ - 1;
+		state_[pos_] = x;
+		state_[pos_ + M] = x;
+
+		const float *w = &state_[pos_];
+		const float *h = h_.data();
+		const size_t A = DSP_FIR_ACCUMULATORS;
+		float acc[A] = {};
+		size_t k = 0;
+		if(symmetric_)
+		{
+			const size_t half = M / 2;
+			for(; k + A <= half; k += A)
+			{
+				for(size_t i = 0; i < A; i++) acc[i] += h[k + i] * (w[k + i] + w[M - 1 - k - i]);
+			}
+			for(; k < half; k++) acc[0] += h[k] * (w[k] + w[M - 1 - k]);
+			if(M & 1) acc[1] += h[half] * w[half];
+		}
+		else
+		{
+			for(; k + A <= M; k += A)
+			{
+				for(size_t i = 0; i < A; i++) acc[i] += h[k + i] * w[k + i];
+			}
+			for(; k < M; k++) acc[0] += h[k] * w[k];
+		}
+
+		float y = 0.0F;
+		for(size_t i = 0; i < A; i++) y += acc[i];
+		return y;
+	}
+
+	// Filter len samples, x and y may point to the same buffer
+	void process(const float *x, float *y, size_t len)
+	{
+		for(size_t n = 0; n < len; n++)
+		{
+			y[n] = process(x[n]);
+		}
+	}
+
+	/*
+	 * Filter a whole interleaved AudioBuffer frame in one call.
+	 * len is the number of int16 entries (bytesRead/2). Only the left channel
+	 * is filtered and the clipped result is written to both L and R, exactly
+	 * as the per-sample loop in Lab9 did.
+	 */
+	void processAudioBuffer(int16_t *buffer, size_t len)
+	{
+		for(size_t n = 0; n + 1 < len; n += 2)
+		{
+			float y = process(toFloat(buffer[n]));
+			buffer[n] = toInt16(y);
+			buffer[n + 1] = buffer[n];
+		}
+	}
+
+private:
+	std::vector<float> h_;		// h[0..M-1]
+	std::vector<float> state_;	// Mirrored delay line, 2*M samples
+	size_t pos_ = 0;			// Position of x[n] inside the delay line
+	bool symmetric_ = false;	// Folded linear-phase structure
+};
+
+} // namespace dsp
+
+#endif /* DSP_FIR_H_ */
@@ -0,0 +1,207 @@
+/*
+ * fir_design.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Windowed-sinc FIR design: low-pass, high-pass, band-pass and band-stop with
+ *  rectangular, Hamming, Blackman or Kaiser windows, the Kaiser length/beta
+ *  estimators, and a cache so a redesign with known parameters is a lookup.
+ *
+ *  Frequencies are in rad/sample (wc = 2*pi*Fc/Fs), as in Clase-11-Abril.
+ */
+
+#ifndef DSP_FIR_DESIGN_H_
+#define DSP_FIR_DESIGN_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace dsp {
+
+/* Exported typedef -----------------------------------------------------------*/
+enum FirType { FIR_LOWPASS = 0, FIR_HIGHPASS, FIR_BANDPASS, FIR_BANDSTOP };
+
+enum FirWindow { FIR_WIN_RECTANGULAR = 0, FIR_WIN_HAMMING, FIR_WIN_BLACKMAN, FIR_WIN_KAISER };
+
+struct FirDesignSpec
+{
+	FirType type;
+	float w1;			// Cutoff (LP/HP) or lower band edge (BP/BS), rad/sample
+	float w2;			// Upper band edge (BP/BS), unused otherwise
+	int numTaps;
+	FirWindow window;
+	float beta;			// Kaiser shape parameter, unused otherwise
+};
+
+/* Exported function prototypes -----------------------------------------------*/
+// Zeroth order modified Bessel function of the first kind (power series)
+inline double besselI0(double x)
+{
+	double sum = 1.0, term = 1.0, q = x * x / 4.0;
+	for(int k = 1; k < 50; k++)
+	{
+		term *= q / ((double)k * (double)k);
+		sum += term;
+		if(term < 1e-12 * sum) break;
+	}
+	return sum;
+}
+
+// Kaiser beta for a stopband attenuation of attenDb (Kaiser's formula)
+inline float kaiserBeta(float attenDb)
+{
+	if(attenDb > 50.0F) return 0.1102F * (attenDb - 8.7F);
+	if(attenDb >= 21.0F) return 0.5842F * powf(attenDb - 21.0F, 0.4F) + 0.07886F * (attenDb - 21.0F);
+	return 0.0F;
+}
+
+/*
+ * Kaiser length estimate M = (A - 8) / (2.285 * dw) + 1 for attenDb of
+ * stopband attenuation and a transition band of dw rad/sample. Rounded up
+ * to an odd length so every response type can use it.
+ */
+inline int kaiserLength(float attenDb, float dw)
+{
+	int M = (int)ceil((attenDb - 8.0) / (2.285 * dw)) + 1;
+	if(M < 3) M = 3;
+	return (M & 1) ? M : M + 1;
+}
+
+inline double firWindow(FirWindow win, int k, int M, float beta)
+{
+	if(M < 2) return 1.0;
+	const double r = (double)k / (double)(M - 1);
+	switch(win)
+	{
+	case FIR_WIN_HAMMING: return 0.54 - 0.46 * cos(2.0 * M_PI * r);
+	case FIR_WIN_BLACKMAN: return 0.42 - 0.5 * cos(2.0 * M_PI * r) + 0.08 * cos(4.0 * M_PI * r);
+	case FIR_WIN_KAISER:
+	{
+		double t = 2.0 * r - 1.0;
+		return besselI0(beta * sqrt(1.0 - t * t)) / besselI0(beta);
+	}
+	default: return 1.0;
+	}
+}
+
+// Ideal low-pass impulse response at offset m from the center
+inline double firSinc(double wc, double m)
+{
+	return (m == 0.0) ? wc / M_PI : sin(wc * m) / (M_PI * m);
+}
+
+/*
+ * Design spec.numTaps taps into h. Returns 1 on success, 0 for an invalid
+ * spec: high-pass and band-stop need an odd length (an even symmetric FIR
+ * has a zero at w = pi), and the band edges must satisfy 0 < w1 < w2 < pi.
+ * The center (M-1)/2 is computed in floating point.
+ */
+inline int firDesign(const FirDesignSpec &spec, float *h)
+{
+	const int M = spec.numTaps;
+	if(M < 1) return 0;
+	if((spec.type == FIR_HIGHPASS || spec.type == FIR_BANDSTOP) && !(M & 1)) return 0;
+	if(spec.w1 <= 0.0F || spec.w1 >= (float)M_PI) return 0;
+	if((spec.type == FIR_BANDPASS || spec.type == FIR_BANDSTOP) && (spec.w2 <= spec.w1 || spec.w2 >= (float)M_PI)) return 0;
+
+	const double c = (double)(M - 1) / 2.0;
+	for(int k = 0; k < M; k++)
+	{
+		const double m = (double)k - c;
+		const double delta = (m == 0.0) ? 1.0 : 0.0;
+		double hd;
+		switch(spec.type)
+		{
+		case FIR_HIGHPASS: hd = delta - firSinc(spec.w1, m); break;
+		case FIR_BANDPASS: hd = firSinc(spec.w2, m) - firSinc(spec.w1, m); break;
+		case FIR_BANDSTOP: hd = delta - firSinc(spec.w2, m) + firSinc(spec.w1, m); break;
+		default: hd = firSinc(spec.w1, m); break;
+		}
+		h[k] = (float)(hd * firWindow(spec.window, k, M, spec.beta));
+	}
+	return 1;
+}
+
+/* Exported class -------------------------------------------------------------*/
+/*
+ * Memoizing front end to firDesign(). Designs are keyed by the exact spec
+ * (type, band edges, taps, window, beta), so switching back and forth between
+ * parameter sets costs a map lookup instead of M sin() calls. When the cache
+ * holds maxEntries designs, the least recently used one is evicted before
+ * the next one is inserted. A pointer returned by get() stays valid until
+ * its design is evicted (maxEntries other designs requested since its last
+ * get()) or clear() is called; map nodes do not move on insertion.
+ */
+class FirDesignCache
+{
+public:
+	explicit FirDesignCache(size_t maxEntries = 32) : maxEntries_(maxEntries) {}
+
+	// Taps for spec, or nullptr if the spec is invalid
+	const std::vector<float> *get(const FirDesignSpec &spec)
+	{
+		Key key = makeKey(spec);
+		auto it = cache_.find(key);
+		if(it != cache_.end())
+		{
+			hits_++;
+			it->second.lastUse = ++clock_;
+			return &it->second.h;
+		}
+
+		misses_++;
+		std::vector<float> h(spec.numTaps > 0 ? spec.numTaps : 0);
+		if(!firDesign(spec, h.data())) return nullptr;
+		if(!cache_.empty() && cache_.size() >= maxEntries_)
+		{
+			// Linear scan: maxEntries is small and this only runs on a miss
+			auto lru = cache_.begin();
+			for(auto e = cache_.begin(); e != cache_.end(); ++e)
+			{
+				if(e->second.lastUse < lru->second.lastUse) lru = e;
+			}
+			cache_.erase(lru);
+		}
+		Entry &e = cache_[key];
+		e.h = std::move(h);
+		e.lastUse = ++clock_;
+		return &e.h;
+	}
+
+	void clear() { cache_.clear(); }
+	size_t size() const { return cache_.size(); }
+	size_t hits() const { return hits_; }
+	size_t misses() const { return misses_; }
+
+private:
+	typedef std::tuple<int, float, float, int, int, float> Key;
+
+	static Key makeKey(const FirDesignSpec &s)
+	{
+		// w2 and beta do not change the design for every type, normalize them
+		bool band = s.type == FIR_BANDPASS || s.type == FIR_BANDSTOP;
+		return Key((int)s.type, s.w1, band ? s.w2 : 0.0F, s.numTaps, (int)s.window,
+				s.window == FIR_WIN_KAISER ? s.beta : 0.0F);
+	}
+
+	struct Entry
+	{
+		std::vector<float> h;
+		size_t lastUse = 0;		// clock_ at the last get() of this design
+	};
+
+	std::map<Key, Entry> cache_;
+	size_t maxEntries_;
+	size_t clock_ = 0;
+	size_t hits_ = 0, misses_ = 0;
+};
+
+} // namespace dsp
+
+#endif /* DSP_FIR_DESIGN_H_ */
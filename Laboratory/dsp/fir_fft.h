@@ -0,0 +1,198 @@
+/*
+ * fir_fft.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Overlap-save FFT convolution for long FIR filters, and FirEngine, which
+ *  exposes it through the same interface as FirFilter. FirEngine defaults to
+ *  the direct form (no delay, a drop-in for FirFilter); the FFT path delays
+ *  the output and has to be asked for.
+ */
+
+#ifndef DSP_FIR_FFT_H_
+#define DSP_FIR_FFT_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "fft.h"
+#include "fir.h"
+
+/* Exported define ------------------------------------------------------------*/
+// Tap count from which FFT convolution beats the (folded) direct form, from
+// bench/bench_fir_fft.cpp with 16-sample AudioBuffer frames on the host
+#ifndef DSP_FIR_FFT_CROSSOVER
+#define DSP_FIR_FFT_CROSSOVER	(64)
+#endif
+
+namespace dsp {
+
+/* Exported class -------------------------------------------------------------*/
+/*
+ * Overlap-save convolver. With an FFT of N >= 4*M points each block produces
+ * L = N - M + 1 >= 3*M outputs from the last N inputs (N = 2*M would halve the
+ * latency but costs about 1.5x the cycles per sample):
+ *   y_block = last L samples of IFFT( FFT(x[n-N+1..n]) * H )
+ * Inputs are collected until L are available, so any caller block size works
+ * (kit.read frames of 16 samples, a whole file, single samples) and the
+ * output is the direct-form output delayed by latency() = L samples.
+ * No taps behaves as a single zero tap (all-zero output).
+ */
+class FftConvolver
+{
+public:
+	FftConvolver() {}
+	FftConvolver(const float *h, size_t numTaps) { setCoefs(h, numTaps); }
+
+	void setCoefs(const float *h, size_t numTaps)
+	{
+		static const float zero = 0.0F;
+		if(numTaps == 0)
+		{
+			h = &zero;
+			numTaps = 1;
+		}
+		M_ = numTaps;
+		N_ = nextPow2(4 * numTaps);
+		if(N_ < 16) N_ = 16;
+		L_ = N_ - M_ + 1;
+
+		fft_.init(N_);
+		H_.resize(N_ / 2 + 1);
+		X_.resize(N_ / 2 + 1);
+		time_.assign(N_, 0.0F);
+		for(size_t k = 0; k < M_; k++) time_[k] = h[k];
+		fft_.forward(time_.data(), H_.data());
+		reset();
+	}
+
+	void reset()
+	{
+		in_.assign(N_, 0.0F);
+		out_.assign(L_, 0.0F);
+		fill_ = 0;
+	}
+
+	size_t numTaps() const { return M_; }
+	size_t fftSize() const { return N_; }
+	size_t latency() const { return L_; }
+
+	float process(float x)
+	{
+		float y = out_[fill_];
+		in_[M_ - 1 + fill_] = x;
+		if(++fill_ == L_) runBlock();
+		return y;
+	}
+
+	// Filter len samples, x and y may point to the same buffer
+	void process(const float *x, float *y, size_t len)
+	{
+		while(len)
+		{
+			size_t n = L_ - fill_;
+			if(n > len) n = len;
+			memcpy(&in_[M_ - 1 + fill_], x, n * sizeof(float));
+			memcpy(y, &out_[fill_], n * sizeof(float));
+			fill_ += n;
+			if(fill_ == L_) runBlock();
+			x += n;
+			y += n;
+			len -= n;
+		}
+	}
+
+private:
+	void runBlock()
+	{
+		fft_.forward(in_.data(), X_.data());
+		for(size_t k = 0; k <= N_ / 2; k++) X_[k] = ComplexFft::mul(X_[k], H_[k]);
+		fft_.inverse(X_.data(), time_.data());
+
+		// The first M-1 outputs are circularly aliased, the last L are valid
+		memcpy(out_.data(), &time_[M_ - 1], L_ * sizeof(float));
+
+		// Keep the newest M-1 inputs as the overlap of the next block
+		memmove(in_.data(), &in_[L_], (M_ - 1) * sizeof(float));
+		fill_ = 0;
+	}
+
+	size_t M_ = 0, N_ = 0, L_ = 0;
+	RealFft fft_;
+	std::vector<cfloat> H_;		// FFT of the zero padded taps
+	std::vector<cfloat> X_;		// Spectrum of the current block
+	std::vector<float> in_;		// M-1 overlap samples + L new ones
+	std::vector<float> out_;	// Outputs of the last block, emitted with L delay
+	std::vector<float> time_;	// IFFT output
+	size_t fill_ = 0;			// New samples collected in the current block
+};
+
+enum FirMethod { FIR_METHOD_AUTO = 0, FIR_METHOD_DIRECT, FIR_METHOD_FFT };
+
+/*
+ * FIR front end with the FirFilter interface. FIR_METHOD_DIRECT (the
+ * default) is FirFilter, folded when symmetric, with the same group delay.
+ * The FFT path is opt-in because it adds latency() samples of delay: a
+ * caller that asks for FIR_METHOD_FFT, or FIR_METHOD_AUTO (FFT from
+ * DSP_FIR_FFT_CROSSOVER taps up), has to drop or accept those samples.
+ */
+class FirEngine
+{
+public:
+	FirEngine() {}
+	FirEngine(const float *h, size_t numTaps, FirMethod method = FIR_METHOD_DIRECT) { setCoefs(h, numTaps, method); }
+
+	void setCoefs(const float *h, size_t numTaps, FirMethod method = FIR_METHOD_DIRECT)
+	{
+		if(method == FIR_METHOD_AUTO)
+		{
+			method = numTaps >= DSP_FIR_FFT_CROSSOVER ? FIR_METHOD_FFT : FIR_METHOD_DIRECT;
+		}
+		method_ = method;
+		if(method_ == FIR_METHOD_FFT) fft_.setCoefs(h, numTaps);
+		else direct_.setCoefs(h, numTaps);
+	}
+
+	void reset()
+	{
+		if(method_ == FIR_METHOD_FFT) fft_.reset();
+		else direct_.reset();
+	}
+
+	FirMethod method() const { return method_; }
+	size_t latency() const { return method_ == FIR_METHOD_FFT ? fft_.latency() : 0; }
+
+	float process(float x)
+	{
+		return method_ == FIR_METHOD_FFT ? fft_.process(x) : direct_.process(x);
+	}
+
+	void process(const float *x, float *y, size_t len)
+	{
+		if(method_ == FIR_METHOD_FFT) fft_.process(x, y, len);
+		else direct_.process(x, y, len);
+	}
+
+	// Same contract as FirFilter::processAudioBuffer
+	void processAudioBuffer(int16_t *buffer, size_t len)
+	{
+		for(size_t n = 0; n + 1 < len; n += 2)
+		{
+			float y = process(toFloat(buffer[n]));
+			buffer[n] = toInt16(y);
+			buffer[n + 1] = buffer[n];
+		}
+	}
+
+private:
+	FirMethod method_ = FIR_METHOD_DIRECT;
+	FirFilter direct_;
+	FftConvolver fft_;
+};
+
+} // namespace dsp
+
+#endif /* DSP_FIR_FFT_H_ */
@@ -0,0 +1,280 @@
+/*
+ * fir_q15.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Fixed-point FIR and gain working directly on the int16 DMA buffers, for
+ *  the MCU builds (ESP32 sketches and the Cortex-M4 in lab5). Plain C so the
+ *  STM32 project can include it too; all functions are static inline.
+ *
+ *  - FIR_Q15: Q15 taps, Q15 samples. The products are Q30 and are summed in
+ *    a 32-bit accumulator when sum|h| < 2 (it cannot overflow then, and maps
+ *    to SMLABB/SMLAD on the M4), otherwise in a 64-bit accumulator.
+ *  - FIR_Q31: Q31 taps, Q15 samples, Q46 products in a 64-bit accumulator.
+ *    Use it for long or low-cutoff filters whose small taps lose too many
+ *    bits in Q15.
+ *  Both round to nearest, saturate to int16 and fold symmetric taps.
+ */
+
+#ifndef DSP_FIR_Q15_H_
+#define DSP_FIR_Q15_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported typedef -----------------------------------------------------------*/
+typedef struct
+{
+	const int16_t *coefs;	// h[0..M-1] in Q15
+	int16_t *state;			// Mirrored delay line, 2*M samples (user memory)
+	uint16_t numTaps;
+	uint16_t pos;			// Position of x[n] inside the delay line
+	uint8_t symmetric;		// h[k] == h[M-1-k], fold the products
+	uint8_t acc32;			// sum|h| < 2, a 32-bit accumulator cannot overflow
+} FirQ15_t;
+
+typedef struct
+{
+	const int32_t *coefs;	// h[0..M-1] in Q31
+	int16_t *state;			// Mirrored delay line, 2*M samples (user memory)
+	uint16_t numTaps;
+	uint16_t pos;
+	uint8_t symmetric;
+} FirQ31_t;
+
+/* Exported define ------------------------------------------------------------*/
+#define Q15_ONE		(32768L)
+#define Q31_ONE		(2147483648.0)
+
+/* Exported function prototypes -----------------------------------------------*/
+static inline int16_t Q15_Sat(int32_t x)
+{
+	return (int16_t)(x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x));
+}
+
+static inline int16_t Q15_Sat64(int64_t x)
+{
+	return (int16_t)(x > INT16_MAX ? INT16_MAX : (x < INT16_MIN ? INT16_MIN : x));
+}
+
+/*
+ * Round the designed taps to Q15 / Q31, saturating at +1 - 1 LSB.
+ * Returns the number of taps that had to be saturated.
+ */
+static inline int FIR_Q15_Quantize(const float *h, int16_t *hq, uint16_t numTaps)
+{
+	int nsat = 0;
+	for(uint16_t k = 0; k < numTaps; k++)
+	{
+		long v = lroundf(h[k] * (float)Q15_ONE);
+		if(v > INT16_MAX) { v = INT16_MAX; nsat++; }
+		if(v < INT16_MIN) { v = INT16_MIN; nsat++; }
+		hq[k] = (int16_t)v;
+	}
+	return nsat;
+}
+
+static inline int FIR_Q31_Quantize(const float *h, int32_t *hq, uint16_t numTaps)
+{
+	int nsat = 0;
+	for(uint16_t k = 0; k < numTaps; k++)
+	{
+		double v = floor((double)h[k] * Q31_ONE + 0.5);
+		if(v > (double)INT32_MAX) { v = (double)INT32_MAX; nsat++; }
+		if(v < (double)INT32_MIN) { v = (double)INT32_MIN; nsat++; }
+		hq[k] = (int32_t)v;
+	}
+	return nsat;
+}
+
+/*
+ * pState must hold 2*numTaps samples. The taps are not copied, pCoefs must
+ * stay valid while the filter is used (a const table in flash is fine).
+ */
+static inline void FIR_Q15_Init(FirQ15_t *pFir, const int16_t *pCoefs, int16_t *pState, uint16_t numTaps)
+{
+	uint32_t l1 = 0;
+	pFir->coefs = pCoefs;
+	pFir->state = pState;
+	pFir->numTaps = numTaps;
+	pFir->pos = 0;
+	pFir->symmetric = numTaps > 1;
+	for(uint16_t k = 0; k < numTaps; k++)
+	{
+		pState[k] = pState[k + numTaps] = 0;
+		l1 += (uint32_t)(pCoefs[k] < 0 ? -(int32_t)pCoefs[k] : pCoefs[k]);
+		if(pCoefs[k] != pCoefs[numTaps - 1 - k]) pFir->symmetric = 0;
+	}
+	// |acc| <= sum|h| * 2^15 + 2^14 (folding does not change the bound)
+	pFir->acc32 = l1 < 2 * Q15_ONE;
+}
+
+static inline void FIR_Q31_Init(FirQ31_t *pFir, const int32_t *pCoefs, int16_t *pState, uint16_t numTaps)
+{
+	pFir->coefs = pCoefs;
+	pFir->state = pState;
+	pFir->numTaps = numTaps;
+	pFir->pos = 0;
+	pFir->symmetric = numTaps > 1;
+	for(uint16_t k = 0; k < numTaps; k++)
+	{
+		pState[k] = pState[k + numTaps] = 0;
+		if(pCoefs[k] != pCoefs[numTaps - 1 - k]) pFir->symmetric = 0;
+	}
+}
+
+// y[n] = sat(round(sum_k h[k]*x[n-k] >> 15))
+static inline int16_t FIR_Q15_ProcessSample(FirQ15_t *pFir, int16_t x)
+{
+	const uint32_t M = pFir->numTaps;
+	const int16_t *h = pFir->coefs;
+	const int16_t *w;
+	uint32_t k;
+
+	if(M == 0) return 0;	// No taps: h is all zero
+	pFir->pos = (uint16_t)((pFir->pos == 0U) ? M - 1U : pFir->pos - 1U);
+	pFir->state[pFir->pos] = x;
+	pFir->state[pFir->pos + M] = x;
+	w = &pFir->state[pFir->pos];
+
+	if(pFir->acc32)
+	{
+		int32_t acc = 1L << 14;
+		if(pFir->symmetric)
+		{
+			for(k = 0; k < M / 2; k++) acc += (int32_t)h[k] * ((int32_t)w[k] + w[M - 1 - k]);
+			if(M & 1) acc += (int32_t)h[M / 2] * w[M / 2];
+		}
+		else
+		{
+			for(k = 0; k < M; k++) acc += (int32_t)h[k] * w[k];
+		}
+		return Q15_Sat(acc >> 15);
+	}
+	else
+	{
+		int64_t acc = 1L << 14;
+		if(pFir->symmetric)
+		{
+			for(k = 0; k < M / 2; k++) acc += (int32_t)h[k] * ((int32_t)w[k] + w[M - 1 - k]);
+			if(M & 1) acc += (int32_t)h[M / 2] * w[M / 2];
+		}
+		else
+		{
+			for(k = 0; k < M; k++) acc += (int32_t)h[k] * w[k];
+		}
+		return Q15_Sat64(acc >> 15);
+	}
+}
+
+// y[n] = sat(round(sum_k h[k]*x[n-k] >> 31))
+static inline int16_t FIR_Q31_ProcessSample(FirQ31_t *pFir, int16_t x)
+{
+	const uint32_t M = pFir->numTaps;
+	const int32_t *h = pFir->coefs;
+	const int16_t *w;
+	int64_t acc = 1LL << 30;
+	uint32_t k;
+
+	if(M == 0) return 0;	// No taps: h is all zero
+	pFir->pos = (uint16_t)((pFir->pos == 0U) ? M - 1U : pFir->pos - 1U);
+	pFir->state[pFir->pos] = x;
+	pFir->state[pFir->pos + M] = x;
+	w = &pFir->state[pFir->pos];
+
+	if(pFir->symmetric)
+	{
+		for(k = 0; k < M / 2; k++) acc += (int64_t)h[k] * ((int32_t)w[k] + w[M - 1 - k]);
+		if(M & 1) acc += (int64_t)h[M / 2] * w[M / 2];
+	}
+	else
+	{
+		for(k = 0; k < M; k++) acc += (int64_t)h[k] * w[k];
+	}
+	return Q15_Sat64(acc >> 31);
+}
+
+/*
+ * Filter len samples read every inStride entries of pIn and written every
+ * outStride entries of pOut (1 for mono, 2 for one channel of an interleaved
+ * L/R buffer). pIn and pOut may be the same buffer.
+ */
+static inline void FIR_Q15_Process(FirQ15_t *pFir, const int16_t *pIn, int16_t *pOut, uint16_t len, uint8_t inStride, uint8_t outStride)
+{
+	for(uint16_t n = 0; n < len; n++)
+	{
+		pOut[n * outStride] = FIR_Q15_ProcessSample(pFir, pIn[n * inStride]);
+	}
+}
+
+static inline void FIR_Q31_Process(FirQ31_t *pFir, const int16_t *pIn, int16_t *pOut, uint16_t len, uint8_t inStride, uint8_t outStride)
+{
+	for(uint16_t n = 0; n < len; n++)
+	{
+		pOut[n * outStride] = FIR_Q31_ProcessSample(pFir, pIn[n * inStride]);
+	}
+}
+
+/*
+ * Same contract as dsp::FirFilter::processAudioBuffer: len is the number of
+ * int16 entries of the interleaved L/R buffer, the Left channel is filtered
+ * and the result is written to both channels. No float conversion at all.
+ */
+static inline void FIR_Q15_ProcessAudioBuffer(FirQ15_t *pFir, int16_t *pBuffer, uint16_t len)
+{
+	for(uint16_t n = 0; n + 1 < len; n += 2)
+	{
+		pBuffer[n] = pBuffer[n + 1] = FIR_Q15_ProcessSample(pFir, pBuffer[n]);
+	}
+}
+
+static inline void FIR_Q31_ProcessAudioBuffer(FirQ31_t *pFir, int16_t *pBuffer, uint16_t len)
+{
+	for(uint16_t n = 0; n + 1 < len; n += 2)
+	{
+		pBuffer[n] = pBuffer[n + 1] = FIR_Q31_ProcessSample(pFir, pBuffer[n]);
+	}
+}
+
+/*
+ * Gain stage: y = sat(x * scaleFract * 2^shift), scaleFract in Q15 (same
+ * convention as CMSIS arm_scale_q15). len counts int16 entries of pBuffer and
+ * the gain is applied to every stride-th one (stride 2: one channel of L/R).
+ * The shift is clamped to [-17, 16]: |x * scaleFract| <= 2^30, so anything
+ * below rounds every sample to 0 and anything above saturates every nonzero one.
+ */
+static inline void Q15_Scale(int16_t *pBuffer, uint16_t len, uint8_t stride, int16_t scaleFract, int8_t shift)
+{
+	const int rshift = 15 - (shift < -17 ? -17 : shift > 16 ? 16 : shift);
+	const int64_t round = rshift > 0 ? ((int64_t)1 << (rshift - 1)) : 0;
+	for(uint16_t n = 0; n < len; n += stride)
+	{
+		int32_t p = (int32_t)pBuffer[n] * scaleFract;
+		// Multiply rather than left-shift: shifting a negative value is undefined in C
+		pBuffer[n] = Q15_Sat64(rshift >= 0 ? ((int64_t)p + round) >> rshift : (int64_t)p * ((int64_t)1 << -rshift));
+	}
+}
+
+// Q31 gain for fine steps: y = sat(x * gain / 2^31 * 2^shift), shift < 31
+static inline void Q31_Scale(int16_t *pBuffer, uint16_t len, uint8_t stride, int32_t gain, int8_t shift)
+{
+	const int rshift = 31 - shift;
+	for(uint16_t n = 0; n < len; n += stride)
+	{
+		int64_t p = (int64_t)pBuffer[n] * gain + (1LL << (rshift - 1));
+		pBuffer[n] = Q15_Sat64(p >> rshift);
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_FIR_Q15_H_ */
@@ -0,0 +1,274 @@
+/*
+ * fir_simd.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Vectorized block FIR kernels for host-side (offline) processing.
+ *  SSE2, AVX2+FMA and AVX-512F versions are compiled with per-function target
+ *  attributes and the best one is picked at runtime from the CPU features, so
+ *  the same binary runs on any x86-64. Other targets use the scalar kernel.
+ *
+ *  Tolerance: the vector kernels sum the products in a different order than
+ *  the scalar reference (and FMA skips one rounding), so outputs match within
+ *    |y - y_ref| <= 2 * M * FLT_EPSILON * sum_k |h[k]| * max |x|
+ *  which is firSimdTolerance() below. bench/bench_fir_simd.cpp checks it.
+ */
+
+#ifndef DSP_FIR_SIMD_H_
+#define DSP_FIR_SIMD_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DSP_FIR_SIMD_X86	(1)
+#endif
+
+namespace dsp {
+
+/* Exported typedef -----------------------------------------------------------*/
+/*
+ * y[n] = hr[0]*x[n] + hr[1]*x[n+1] + ... + hr[M-1]*x[n+M-1],  n = 0..len-1
+ * hr is the time-reversed impulse response and x holds M-1 history samples
+ * followed by the len new ones (oldest first), so every output is a
+ * contiguous dot product that can be computed for several n at once.
+ */
+typedef void (*FirKernel)(const float *x, const float *hr, float *y, size_t M, size_t len);
+
+enum FirIsa { FIR_ISA_SCALAR = 0, FIR_ISA_SSE2, FIR_ISA_AVX2, FIR_ISA_AVX512 };
+
+/* Exported function prototypes -----------------------------------------------*/
+inline void firKernelScalar(const float *x, const float *hr, float *y, size_t M, size_t len)
+{
+	for(size_t n = 0; n < len; n++)
+	{
+		float acc = 0.0F;
+		for(size_t k = 0; k < M; k++)
+		{
+			acc += hr[k] * x[n + k];
+		}
+		y[n] = acc;
+	}
+}
+
+#ifdef DSP_FIR_SIMD_X86
+// 4 accumulators x 4 lanes = 16 outputs per pass over the taps
+__attribute__((target("sse2")))
+inline void firKernelSse2(const float *x, const float *hr, float *y, size_t M, size_t len)
+{
+	size_t n = 0;
+	for(; n + 16 <= len; n += 16)
+	{
+		__m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps();
+		__m128 a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+		for(size_t k = 0; k < M; k++)
+		{
+			const float *p = x + n + k;
+			__m128 h = _mm_set1_ps(hr[k]);
+			a0 = _mm_add_ps(a0, _mm_mul_ps(h, _mm_loadu_ps(p)));
+			a1 = _mm_add_ps(a1, _mm_mul_ps(h, _mm_loadu_ps(p + 4)));
+			a2 = _mm_add_ps(a2, _mm_mul_ps(h, _mm_loadu_ps(p + 8)));
+			a3 = _mm_add_ps(a3, _mm_mul_ps(h, _mm_loadu_ps(p + 12)));
+		}
+		_mm_storeu_ps(y + n, a0);
+		_mm_storeu_ps(y + n + 4, a1);
+		_mm_storeu_ps(y + n + 8, a2);
+		_mm_storeu_ps(y + n + 12, a3);
+	}
+	for(; n + 4 <= len; n += 4)
+	{
+		__m128 a0 = _mm_setzero_ps();
+		for(size_t k = 0; k < M; k++)
+		{
+			a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_set1_ps(hr[k]), _mm_loadu_ps(x + n + k)));
+		}
+		_mm_storeu_ps(y + n, a0);
+	}
+	firKernelScalar(x + n, hr, y + n, M, len - n);
+}
+
+// 4 accumulators x 8 lanes = 32 outputs per pass over the taps
+__attribute__((target("avx2,fma")))
+inline void firKernelAvx2(const float *x, const float *hr, float *y, size_t M, size_t len)
+{
+	size_t n = 0;
+	for(; n + 32 <= len; n += 32)
+	{
+		__m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps();
+		__m256 a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+		for(size_t k = 0; k < M; k++)
+		{
+			const float *p = x + n + k;
+			__m256 h = _mm256_broadcast_ss(hr + k);
+			a0 = _mm256_fmadd_ps(h, _mm256_loadu_ps(p), a0);
+			a1 = _mm256_fmadd_ps(h, _mm256_loadu_ps(p + 8), a1);
+			a2 = _mm256_fmadd_ps(h, _mm256_loadu_ps(p + 16), a2);
+			a3 = _mm256_fmadd_ps(h, _mm256_loadu_ps(p + 24), a3);
+		}
+		_mm256_storeu_ps(y + n, a0);
+		_mm256_storeu_ps(y + n + 8, a1);
+		_mm256_storeu_ps(y + n + 16, a2);
+		_mm256_storeu_ps(y + n + 24, a3);
+	}
+	for(; n + 8 <= len; n += 8)
+	{
+		__m256 a0 = _mm256_setzero_ps();
+		for(size_t k = 0; k < M; k++)
+		{
+			a0 = _mm256_fmadd_ps(_mm256_broadcast_ss(hr + k), _mm256_loadu_ps(x + n + k), a0);
+		}
+		_mm256_storeu_ps(y + n, a0);
+	}
+	firKernelScalar(x + n, hr, y + n, M, len - n);
+}
+
+// 4 accumulators x 16 lanes = 64 outputs per pass over the taps
+__attribute__((target("avx512f")))
+inline void firKernelAvx512(const float *x, const float *hr, float *y, size_t M, size_t len)
+{
+	size_t n = 0;
+	for(; n + 64 <= len; n += 64)
+	{
+		__m512 a0 = _mm512_setzero_ps(), a1 = _mm512_setzero_ps();
+		__m512 a2 = _mm512_setzero_ps(), a3 = _mm512_setzero_ps();
+		for(size_t k = 0; k < M; k++)
+		{
+			const float *p = x + n + k;
+			__m512 h = _mm512_set1_ps(hr[k]);
+			a0 = _mm512_fmadd_ps(h, _mm512_loadu_ps(p), a0);
+			a1 = _mm512_fmadd_ps(h, _mm512_loadu_ps(p + 16), a1);
+			a2 = _mm512_fmadd_ps(h, _mm512_loadu_ps(p + 32), a2);
+			a3 = _mm512_fmadd_ps(h, _mm512_loadu_ps(p + 48), a3);
+		}
+		_mm512_storeu_ps(y + n, a0);
+		_mm512_storeu_ps(y + n + 16, a1);
+		_mm512_storeu_ps(y + n + 32, a2);
+		_mm512_storeu_ps(y + n + 48, a3);
+	}
+	for(; n + 16 <= len; n += 16)
+	{
+		__m512 a0 = _mm512_setzero_ps();
+		for(size_t k = 0; k < M; k++)
+		{
+			a0 = _mm512_fmadd_ps(_mm512_set1_ps(hr[k]), _mm512_loadu_ps(x + n + k), a0);
+		}
+		_mm512_storeu_ps(y + n, a0);
+	}
+	firKernelScalar(x + n, hr, y + n, M, len - n);
+}
+#endif /* DSP_FIR_SIMD_X86 */
+
+// Widest instruction set supported by the running CPU
+inline FirIsa firDetectIsa()
+{
+#ifdef DSP_FIR_SIMD_X86
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx512f")) return FIR_ISA_AVX512;
+	if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return FIR_ISA_AVX2;
+	if(__builtin_cpu_supports("sse2")) return FIR_ISA_SSE2;
+#endif
+	return FIR_ISA_SCALAR;
+}
+
+// Kernel for isa, falls back to scalar when it was not compiled in
+inline FirKernel firGetKernel(FirIsa isa)
+{
+#ifdef DSP_FIR_SIMD_X86
+	switch(isa)
+	{
+	case FIR_ISA_AVX512: return firKernelAvx512;
+	case FIR_ISA_AVX2: return firKernelAvx2;
+	case FIR_ISA_SSE2: return firKernelSse2;
+	default: break;
+	}
+#endif
+	return firKernelScalar;
+}
+
+inline const char *firIsaName(FirIsa isa)
+{
+	static const char *names[] = {"scalar", "sse2", "avx2", "avx512"};
+	return names[isa];
+}
+
+// Error bound against the scalar reference for inputs bounded by xmax
+inline float firSimdTolerance(const float *h, size_t M, float xmax)
+{
+	float l1 = 0.0F;
+	for(size_t k = 0; k < M; k++) l1 += fabsf(h[k]);
+	return 2.0F * (float)M * FLT_EPSILON * l1 * xmax;
+}
+
+/* Exported class -------------------------------------------------------------*/
+/*
+ * Block FIR for long captures. Keeps the last M-1 inputs in front of a work
+ * buffer of up to BLOCK_SIZE new samples and runs the dispatched kernel over
+ * it, so the vector loads never have to wrap around a circular buffer.
+ */
+class FirSimdFilter
+{
+public:
+	static const size_t BLOCK_SIZE = 4096;
+
+	FirSimdFilter() { setIsa(firDetectIsa()); }
+	FirSimdFilter(const float *h, size_t numTaps) : FirSimdFilter() { setCoefs(h, numTaps); }
+
+	void setCoefs(const float *h, size_t numTaps)
+	{
+		hr_.resize(numTaps);
+		for(size_t k = 0; k < numTaps; k++) hr_[k] = h[numTaps - 1 - k];
+		work_.assign(numTaps ? numTaps - 1 + BLOCK_SIZE : 0, 0.0F);
+	}
+
+	// Force a kernel, e.g. to benchmark or to compare against scalar
+	void setIsa(FirIsa isa)
+	{
+		isa_ = isa;
+		kernel_ = firGetKernel(isa);
+	}
+
+	void reset() { work_.assign(work_.size(), 0.0F); }
+
+	FirIsa isa() const { return isa_; }
+	size_t numTaps() const { return hr_.size(); }
+
+	// Filter len samples, x and y may point to the same buffer
+	void process(const float *x, float *y, size_t len)
+	{
+		const size_t M = hr_.size();
+		if(!M)
+		{
+			if(x != y) memmove(y, x, len * sizeof(float));
+			return;
+		}
+
+		float *hist = work_.data();
+		while(len)
+		{
+			size_t L = len < BLOCK_SIZE ? len : BLOCK_SIZE;
+			memcpy(hist + M - 1, x, L * sizeof(float));
+			kernel_(hist, hr_.data(), y, M, L);
+
+			// Keep the newest M-1 inputs as history for the next block
+			memmove(hist, hist + L, (M - 1) * sizeof(float));
+			x += L;
+			y += L;
+			len -= L;
+		}
+	}
+
+private:
+	std::vector<float> hr_;		// h[M-1], ..., h[0]
+	std::vector<float> work_;	// M-1 history samples + BLOCK_SIZE new samples
+	FirKernel kernel_ = firKernelScalar;
+	FirIsa isa_ = FIR_ISA_SCALAR;
+};
+
+} // namespace dsp
+
+#endif /* DSP_FIR_SIMD_H_ */
@@ -0,0 +1,149 @@
+/*
+ * fir_static.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Compile-time FIR: a constexpr windowed-sinc designer and a Fir<N, Coeffs>
+ *  template whose tap count and coefficients are constants, so the compiler
+ *  fully unrolls the MAC and no design code runs at startup.
+ *
+ *    constexpr auto hlp = dsp::firLowPassConst<11>(2*M_PI*500/8000);
+ *    dsp::Fir<11, hlp> fir;
+ */
+
+#ifndef DSP_FIR_STATIC_H_
+#define DSP_FIR_STATIC_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <utility>
+#include "fir.h"
+
+namespace dsp {
+
+/* Exported define ------------------------------------------------------------*/
+#define DSP_PI		(3.14159265358979323846)
+
+/* Exported function prototypes -----------------------------------------------*/
+// sin(x) usable in constant expressions: range reduction plus Taylor series
+constexpr double constSin(double x)
+{
+	// Reduce to [-pi, pi]
+	double k = x / (2.0 * DSP_PI);
+	long long q = (long long)(k < 0 ? k - 0.5 : k + 0.5);
+	x -= (double)q * 2.0 * DSP_PI;
+
+	double term = x, sum = x;
+	for(int i = 1; i < 30; i++)
+	{
+		term *= -x * x / (double)((2 * i) * (2 * i + 1));
+		sum += term;
+	}
+	return sum;
+}
+
+constexpr double constCos(double x) { return constSin(x + DSP_PI / 2.0); }
+
+// Normalized sinc: sin(wc*m)/(pi*m), with the m = 0 limit wc/pi
+constexpr double constSincTap(double wc, double m)
+{
+	return (m == 0.0) ? wc / DSP_PI : constSin(wc * m) / (DSP_PI * m);
+}
+
+enum FirWindowConst { FIR_CONST_RECTANGULAR = 0, FIR_CONST_HAMMING };
+
+constexpr double constWindow(FirWindowConst win, size_t k, size_t M)
+{
+	return (win == FIR_CONST_HAMMING && M > 1)
+			? 0.54 - 0.46 * constCos(2.0 * DSP_PI * (double)k / (double)(M - 1))
+			: 1.0;
+}
+
+/*
+ * Windowed-sinc low-pass, same response as FIR_LowPass_Calc (Clase-11-Abril)
+ * with a rectangular window. wc is in rad/sample. The center (M-1)/2 is kept
+ * in floating point so even lengths are also valid.
+ */
+template <size_t M>
+constexpr std::array<float, M> firLowPassConst(double wc, FirWindowConst win = FIR_CONST_RECTANGULAR)
+{
+	std::array<float, M> h{};
+	const double c = (double)(M - 1) / 2.0;
+	for(size_t k = 0; k < M; k++)
+	{
+		h[k] = (float)(constSincTap(wc, (double)k - c) * constWindow(win, k, M));
+	}
+	return h;
+}
+
+/* Exported class -------------------------------------------------------------*/
+/*
+ * FIR with N taps known at compile time. Uses the same mirrored delay line as
+ * FirFilter (x[n]..x[n-N+1] are contiguous at state[pos]); the dot product is
+ * expanded by a fold expression, so every h[k] becomes an immediate operand.
+ */
+template <size_t N, const std::array<float, N> &Coeffs>
+class Fir
+{
+	static_assert(N > 0, "Fir needs at least one tap");
+
+public:
+	Fir() { reset(); }
+
+	void reset()
+	{
+		state_.fill(0.0F);
+		pos_ = 0;
+	}
+
+	static constexpr size_t numTaps() { return N; }
+	static constexpr const float *coefs() { return Coeffs.data(); }
+
+	// y[n] = x[n]*h[0] + x[n-1]*h[1] + ... + x[n-N+1]*h[N-1]
+	float process(float x)
+	{
+		pos_ = (pos_ == 0) ? N - 1 : pos_ - 1;
+		state_[pos_] = x;
+		state_[pos_ + N] = x;
+		return dot(&state_[pos_], std::make_index_sequence<N>{});
+	}
+
+	// Filter len samples, x and y may point to the same buffer
+	void process(const float *x, float *y, size_t len)
+	{
+		for(size_t n = 0; n < len; n++)
+		{
+			y[n] = process(x[n]);
+		}
+	}
+
+	// Same contract as FirFilter::processAudioBuffer
+	void processAudioBuffer(int16_t *buffer, size_t len)
+	{
+		for(size_t n = 0; n + 1 < len; n += 2)
+		{
+			float y = process(toFloat(buffer[n]));
+			buffer[n] = toInt16(y);
+			buffer[n + 1] = buffer[n];
+		}
+	}
+
+private:
+	template <size_t... K>
+	static float dot(const float *w, std::index_sequence<K...>)
+	{
+		float y = 0.0F;
+		((y += Coeffs[K] * w[K]), ...);
+		return y;
+	}
+
+	std::array<float, 2 * N> state_;	// Mirrored delay line
+	size_t pos_ = 0;					// Position of x[n] inside the delay line
+};
+
+} // namespace dsp
+
+#endif /* DSP_FIR_STATIC_H_ */
@@ -0,0 +1,373 @@
+/*
+ * iir.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  IIR filters as a cascade of second-order sections (biquads) in transposed
+ *  direct form II. A transfer function in the form the MATLAB scripts print
+ *  (Laboratory/Lab10/coefs: b_coefs = b0..bN, a_coefs = a1..aN with a0 = 1)
+ *  is factored into biquads by finding its poles and zeros, because a single
+ *  high-order direct form is numerically fragile in float. The factoring
+ *  itself is limited by how well the polynomial coefficients pin down the
+ *  roots: fine for the MATLAB outputs up to order ~8, beyond that design the
+ *  sections directly.
+ */
+
+#ifndef DSP_IIR_H_
+#define DSP_IIR_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <complex>
+#include <vector>
+#include "fir.h"
+#include "silence.h"
+
+namespace dsp {
+
+/* Exported typedef -----------------------------------------------------------*/
+/*
+ * H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+ * First-order sections use b2 = a2 = 0.
+ */
+struct Biquad
+{
+	float b0, b1, b2, a1, a2;
+};
+
+typedef std::complex<double> cdouble;
+
+/* Exported function prototypes -----------------------------------------------*/
+/*
+ * Roots of c[0]*z^N + c[1]*z^(N-1) + ... + c[N]. Roots at z = 0 are divided out first, and
+ * so are z = +-1 when unitRoots is set (zeros of butter() and friends, with
+ * high multiplicity): repeated roots are where the iteration is least
+ * accurate. Never set it for a denominator, whose value at z = 1 is tiny for
+ * any narrow low-pass.
+ */
+inline std::vector<cdouble> polyRoots(std::vector<double> c, bool unitRoots = false)
+{
+	std::vector<cdouble> roots;
+	while(c.size() > 1 && c.back() == 0.0)
+	{
+		roots.push_back(0.0);
+		c.pop_back();
+	}
+	while(c.size() > 1 && c.front() == 0.0) c.erase(c.begin());
+
+	for(double z0 = -1.0; unitRoots && z0 <= 1.0; z0 += 2.0)
+	{
+		while(c.size() > 1)
+		{
+			// Synthetic division by (z - z0), remainder relative to the coefficient size
+			std::vector<double> q(c.size() - 1);
+			double acc = 0.0, mag = 0.0;
+			for(size_t i = 0; i < c.size(); i++)
+			{
+				acc = acc * z0 + c[i];
+				mag += fabs(c[i]);
+				if(i + 1 < c.size()) q[i] = acc;
+			}
+			if(fabs(acc) > 1e-12 * mag) break;
+			roots.push_back(z0);
+			c = q;
+		}
+	}
+
+	const size_t N = c.size() - 1;
+	if(N == 0) return roots;
+	for(size_t i = 1; i <= N; i++) c[i] /= c[0];
+	c[0] = 1.0;
+
+	// Aberth-Ehrlich iteration: converges on clustered roots (narrow-band
+	// filters put all poles near z = 1) where plain Newton or Durand-Kerner stall
+	double R = 0.0;
+	for(size_t i = 1; i <= N; i++) R = std::max(R, fabs(c[i]));
+	R = 1.0 + R;
+	std::vector<cdouble> z(N);
+	for(size_t i = 0; i < N; i++) z[i] = std::polar(0.5 * R, 2.0 * M_PI * (double)i / (double)N + 0.4);
+
+	for(int it = 0; it < 500; it++)
+	{
+		double change = 0.0;
+		for(size_t i = 0; i < N; i++)
+		{
+			cdouble p = 1.0, dp = 0.0;
+			for(size_t k = 1; k <= N; k++) { dp = dp * z[i] + p; p = p * z[i] + c[k]; }
+			if(std::abs(p) == 0.0) continue;
+			cdouble w = p / dp, s = 0.0;
+			for(size_t j = 0; j < N; j++) if(j != i) s += 1.0 / (z[i] - z[j]);
+			cdouble dz = w / (1.0 - w * s);
+			z[i] -= dz;
+			change = std::max(change, std::abs(dz) / std::max(1.0, std::abs(z[i])));
+		}
+		if(change < 1e-15) break;
+	}
+	roots.insert(roots.end(), z.begin(), z.end());
+	return roots;
+}
+
+/*
+ * Groups roots in second-order factors z^2 + c1 z + c2 (real coefficients):
+ * each complex root with its closest match to the conjugate, then real roots
+ * two by two; a leftover real root becomes z + c1 with c2 = 0.
+ */
+inline std::vector<std::pair<double, double>> pairRoots(std::vector<cdouble> r, double tol = 1e-7)
+{
+	std::vector<std::pair<double, double>> f;
+	std::vector<double> real;
+
+	// Most complex first, so a near-real root never steals a true pair's partner
+	std::sort(r.begin(), r.end(), [](const cdouble &x, const cdouble &y) { return fabs(x.imag()) < fabs(y.imag()); });
+	while(!r.empty())
+	{
+		cdouble a = r.back();
+		r.pop_back();
+		if(fabs(a.imag()) <= tol * std::max(1.0, std::abs(a)) || r.empty())
+		{
+			real.push_back(a.real());
+			continue;
+		}
+		size_t best = 0;
+		for(size_t i = 1; i < r.size(); i++)
+		{
+			if(std::abs(r[i] - std::conj(a)) < std::abs(r[best] - std::conj(a))) best = i;
+		}
+		r.erase(r.begin() + best);
+		f.push_back({-2.0 * a.real(), std::norm(a)});
+	}
+	std::sort(real.begin(), real.end());
+	for(size_t i = 0; i + 1 < real.size(); i += 2) f.push_back({-(real[i] + real[i + 1]), real[i] * real[i + 1]});
+	if(real.size() & 1) f.push_back({-real.back(), 0.0});
+	return f;
+}
+
+/*
+ * Builds sections from second-order factors z^2 + c1 z + c2 of the numerator
+ * (zq) and denominator (pq), as returned by pairRoots(), and the overall
+ * gain. Pole pairs are ordered from the farthest to the closest to the unit
+ * circle and each gets the remaining zero pair nearest to it, which keeps
+ * the peak gain of every intermediate section low. The gain goes into the
+ * first section. lead extra zeros at z = 0 of B(z)/A(z) (pure delays) are
+ * placed in sections without zero pairs, in the free b2 of a first-order
+ * zero factor, and in delay-only sections if any are still left.
+ */
+inline std::vector<Biquad> factorsToSos(std::vector<std::pair<double, double>> zq,
+		std::vector<std::pair<double, double>> pq, double gain, size_t lead = 0)
+{
+	// Radius of a pole pair: sqrt(c2) for complex pairs, max |root| otherwise
+	auto radius = [](const std::pair<double, double> &q) {
+		double disc = q.first * q.first - 4.0 * q.second;
+		if(disc < 0.0) return sqrt(q.second);
+		double s = sqrt(disc);
+		return std::max(fabs((-q.first + s) / 2.0), fabs((-q.first - s) / 2.0));
+	};
+	std::sort(pq.begin(), pq.end(), [&](const std::pair<double, double> &x, const std::pair<double, double> &y) {
+		return radius(x) < radius(y);
+	});
+
+	size_t nsec = std::max(pq.size(), (zq.size() + lead + 1) / 2);
+	if(nsec == 0) nsec = 1;
+	std::vector<Biquad> sos;
+	for(size_t s = 0; s < nsec; s++)
+	{
+		Biquad q = {1.0F, 0.0F, 0.0F, 0.0F, 0.0F};
+		if(s < pq.size())
+		{
+			q.a1 = (float)pq[s].first;
+			q.a2 = (float)pq[s].second;
+		}
+		if(!zq.empty())
+		{
+			// Zero pair closest to this section's poles
+			size_t best = 0;
+			for(size_t i = 1; i < zq.size(); i++)
+			{
+				double di = fabs(zq[i].first - q.a1) + fabs(zq[i].second - q.a2);
+				double db = fabs(zq[best].first - q.a1) + fabs(zq[best].second - q.a2);
+				if(di < db) best = i;
+			}
+			q.b1 = (float)zq[best].first;
+			q.b2 = (float)zq[best].second;
+			zq.erase(zq.begin() + best);
+			if(lead && q.b2 == 0.0F)
+			{
+				// First-order factor: one delay fits in b2
+				q = Biquad{0.0F, q.b0, q.b1, q.a1, q.a2};
+				lead--;
+			}
+		}
+		else if(lead)
+		{
+			// Pure delay z^-1 (or z^-2)
+			size_t d = std::min<size_t>(lead, 2);
+			q = Biquad{0.0F, d == 1 ? 1.0F : 0.0F, d == 2 ? 1.0F : 0.0F, q.a1, q.a2};
+			lead -= d;
+		}
+		sos.push_back(q);
+	}
+	for(; lead; lead -= std::min<size_t>(lead, 2))
+	{
+		sos.push_back(lead == 1 ? Biquad{0.0F, 1.0F, 0.0F, 0.0F, 0.0F} : Biquad{0.0F, 0.0F, 1.0F, 0.0F, 0.0F});
+	}
+
+	sos[0].b0 *= (float)gain;
+	sos[0].b1 *= (float)gain;
+	sos[0].b2 *= (float)gain;
+	return sos;
+}
+
+// Sections from zeros, poles (conjugate pairs complete) and gain k
+inline std::vector<Biquad> zpkToSos(const std::vector<cdouble> &z, const std::vector<cdouble> &p, double k)
+{
+	return factorsToSos(pairRoots(z), pairRoots(p), k);
+}
+
+/*
+ * Factors B(z)/A(z), with b = b0..bM and a = a1..aN (a0 = 1), into biquads
+ * (see factorsToSos() for the pairing). Pass double coefficients when they
+ * are available: rounding a high-order polynomial to float moves its roots
+ * far more than rounding the biquads does.
+ */
+template <typename T>
+std::vector<Biquad> tfToSos(const T *b, size_t nb, const T *a, size_t na)
+{
+	size_t N = std::max(nb ? nb - 1 : 0, na);
+	std::vector<double> num(N + 1, 0.0), den(N + 1, 0.0);
+	for(size_t i = 0; i < nb; i++) num[i] = b[i];
+	den[0] = 1.0;
+	for(size_t i = 0; i < na; i++) den[i + 1] = a[i];
+
+	// Leading zeros of b are pure delays: keep them out of the root finder
+	size_t lead = 0;
+	while(lead < num.size() && num[lead] == 0.0) lead++;
+	if(lead == num.size()) return std::vector<Biquad>(1, Biquad{0.0F, 0.0F, 0.0F, 0.0F, 0.0F});
+
+	std::vector<double> numTrim(num.begin() + lead, num.end());
+	return factorsToSos(pairRoots(polyRoots(numTrim, true)), pairRoots(polyRoots(den)), num[lead], lead);
+}
+
+/* Exported class -------------------------------------------------------------*/
+/*
+ * Biquad cascade, transposed direct form II:
+ *   y  = b0*x + z1
+ *   z1 = b1*x - a1*y + z2
+ *   z2 = b2*x - a2*y
+ * Blocks are processed section by section, so each section's coefficients
+ * and state stay in registers for the whole block.
+ */
+class SosCascade
+{
+public:
+	SosCascade() {}
+	explicit SosCascade(const std::vector<Biquad> &sos) { setSections(sos); }
+
+	// Transfer function as printed by the MATLAB scripts: b0..bM and a1..aN
+	template <typename T>
+	SosCascade(const T *b, size_t nb, const T *a, size_t na) { setTransferFunction(b, nb, a, na); }
+
+	void setSections(const std::vector<Biquad> &sos)
+	{
+		sos_ = sos;
+		reset();
+	}
+
+	template <typename T>
+	void setTransferFunction(const T *b, size_t nb, const T *a, size_t na)
+	{
+		setSections(tfToSos(b, nb, a, na));
+	}
+
+	void reset()
+	{
+		state_.assign(2 * sos_.size(), 0.0F);
+		idle_ = true;
+	}
+
+	// State flushed to zero after a silent block (0: never flush)
+	void setFlushThreshold(float threshold) { flush_ = threshold; }
+
+	size_t numSections() const { return sos_.size(); }
+	const std::vector<Biquad> &sections() const { return sos_; }
+	const SilenceStats_t &silenceStats() const { return stats_; }
+
+	float process(float x)
+	{
+		idle_ = false;
+		float *z = state_.data();
+		for(const Biquad &q : sos_)
+		{
+			float y = q.b0 * x + z[0];
+			z[0] = q.b1 * x - q.a1 * y + z[1];
+			z[1] = q.b2 * x - q.a2 * y;
+			x = y;
+			z += 2;
+		}
+		return x;
+	}
+
+	// Filter len samples, x and y may point to the same buffer. A silent block
+	// into a zero state is skipped (see silence.h).
+	void process(const float *x, float *y, size_t len)
+	{
+		stats_.blocks++;
+		const bool quiet = DSP_IsSilentF32(x, len, 0.0F);
+		if(quiet && idle_)
+		{
+			memset(y, 0, len * sizeof(float));
+			stats_.fastBlocks++;
+			return;
+		}
+
+		float *z = state_.data();
+		for(size_t s = 0; s < sos_.size(); s++, z += 2)
+		{
+			const Biquad q = sos_[s];
+			float z1 = z[0], z2 = z[1];
+			const float *in = (s == 0) ? x : y;
+			for(size_t n = 0; n < len; n++)
+			{
+				float xn = in[n];
+				float yn = q.b0 * xn + z1;
+				z1 = q.b1 * xn - q.a1 * yn + z2;
+				z2 = q.b2 * xn - q.a2 * yn;
+				y[n] = yn;
+			}
+			z[0] = z1;
+			z[1] = z2;
+		}
+		if(sos_.empty() && x != y)
+		{
+			for(size_t n = 0; n < len; n++) y[n] = x[n];
+		}
+		idle_ = quiet && DSP_FlushF32(state_.data(), state_.size(), flush_);
+		stats_.flushes += idle_;
+	}
+
+	// Same contract as FirFilter::processAudioBuffer
+	void processAudioBuffer(int16_t *buffer, size_t len)
+	{
+		for(size_t n = 0; n + 1 < len; n += 2)
+		{
+			float y = process(toFloat(buffer[n]));
+			buffer[n] = toInt16(y);
+			buffer[n + 1] = buffer[n];
+		}
+	}
+
+private:
+	std::vector<Biquad> sos_;
+	std::vector<float> state_;	// z1, z2 per section
+	float flush_ = DSP_STATE_FLUSH;
+	bool idle_ = true;			// state_ is all zero
+	SilenceStats_t stats_ = {0, 0, 0};
+};
+
+} // namespace dsp
+
+#endif /* DSP_IIR_H_ */
@@ -0,0 +1,275 @@
+/*
+ * iir_block.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Time-parallel biquad cascade for long offline buffers. The recursion
+ *  makes every output wait for the previous one, so a single channel cannot
+ *  use SIMD or threads directly. Instead the buffer is cut in K chunks of L
+ *  samples and the cascade is seen as a state-space system with state s (the
+ *  z1/z2 of every section, 2S values):
+ *    s[n+1] = A s[n] + B x[n]
+ *  By linearity, the state at the end of chunk k is
+ *    s_end(k) = A^L s_start(k) + s_zs(k)
+ *  where s_zs(k) is the end state of the chunk run from zero state. So:
+ *    1. every chunk runs from zero state and keeps its end state (parallel),
+ *    2. the true start states follow from a K-step scan with the 2Sx2S
+ *       matrix A^L (look-ahead, computed by repeated squaring),
+ *    3. every chunk runs again from its true start state, writing y (parallel).
+ *  Twice the arithmetic of the sequential filter, but it spreads over W SIMD
+ *  lanes (one chunk per lane, via the iir_simd.h kernels) and T threads.
+ *
+ *  Tolerance: the result equals the sequential one up to rounding; the start
+ *  states carry the float error of step 1 scaled by the cascade's noise gain,
+ *  bench/bench_iir_block.cpp checks it against SosCascade.
+ */
+
+#ifndef DSP_IIR_BLOCK_H_
+#define DSP_IIR_BLOCK_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "iir.h"
+#include "iir_simd.h"
+
+namespace dsp {
+
+/* Exported define ------------------------------------------------------------*/
+#ifndef DSP_IIR_BLOCK_MIN_CHUNK
+#define DSP_IIR_BLOCK_MIN_CHUNK	(1024)		// Shorter chunks: the scan and start-up cost dominate
+#endif
+#define DSP_IIR_BLOCK_TILE		(256)		// Frames gathered per lane kernel call
+
+/* Exported class -------------------------------------------------------------*/
+class BlockIir
+{
+public:
+	BlockIir() { setIsa(firDetectIsa()); setThreads(0); }
+	explicit BlockIir(const std::vector<Biquad> &sos, unsigned numThreads = 0) : BlockIir()
+	{
+		setSections(sos);
+		setThreads(numThreads);
+	}
+
+	void setSections(const std::vector<Biquad> &sos)
+	{
+		sos_ = sos;
+		buildStepMatrix();
+		powL_ = 0;
+		reset();
+	}
+
+	// 0 = one per hardware thread
+	void setThreads(unsigned numThreads)
+	{
+		threads_ = numThreads ? numThreads : std::thread::hardware_concurrency();
+		if(!threads_) threads_ = 1;
+	}
+
+	// Lane width of the chunk kernels: 16 (AVX-512F), 8 (AVX2), 4 (SSE2), 1
+	void setIsa(FirIsa isa)
+	{
+		isa_ = isa;
+		lanes_ = 1;
+		kernel_ = sosLanesScalar;
+#ifdef DSP_FIR_SIMD_X86
+		switch(isa)
+		{
+		case FIR_ISA_AVX512: lanes_ = 16; kernel_ = sosLanesAvx512; break;
+		case FIR_ISA_AVX2: lanes_ = 8; kernel_ = sosLanesAvx2; break;
+		case FIR_ISA_SSE2: lanes_ = 4; kernel_ = sosLanesSse2; break;
+		default: break;
+		}
+#endif
+	}
+
+	void reset() { state_.assign(2 * sos_.size(), 0.0F); }
+
+	size_t numSections() const { return sos_.size(); }
+	unsigned threads() const { return threads_; }
+	FirIsa isa() const { return isa_; }
+
+	// Filter len samples, x and y may point to the same buffer. State carries
+	// over between calls exactly like SosCascade::process().
+	void process(const float *x, float *y, size_t len)
+	{
+		const size_t S = sos_.size();
+		if(!S)
+		{
+			if(x != y) memmove(y, x, len * sizeof(float));
+			return;
+		}
+
+		// K chunks, a multiple of the lane width, of at least MIN_CHUNK samples
+		const size_t groups = threads_;
+		size_t K = groups * lanes_;
+		while(K > 1 && len / K < DSP_IIR_BLOCK_MIN_CHUNK) K = K > lanes_ ? K - lanes_ : 1;
+		// Chunk starts an odd number of cache lines apart: power-of-two strides
+		// would put all the lanes' streams in the same cache sets
+		size_t L = (len / K) & ~(size_t)31;
+		if(L >= 32 && !((L / 16) & 1)) L -= 16;
+		if(K < 2 || (K % lanes_) || !L)
+		{
+			sosLanesScalar(sos_.data(), S, state_.data(), x, y, 1, len);
+			return;
+		}
+		const size_t G = K / lanes_;
+		const size_t D = 2 * S;
+
+		// 1. Zero-state end states of every chunk, lane-major per group
+		std::vector<float> zs(G * D * lanes_, 0.0F);
+		forGroups(G, [&](size_t g) { runGroup(g, x, nullptr, L, &zs[g * D * lanes_]); });
+
+		// 2. Start states: s(k+1) = A^L s(k) + s_zs(k), in double
+		if(powL_ != L) buildPowerMatrix(L);
+		std::vector<float> start(G * D * lanes_);
+		std::vector<double> s(state_.begin(), state_.end()), t(D);
+		for(size_t k = 0; k < K; k++)
+		{
+			const size_t g = k / lanes_, lane = k % lanes_;
+			float *zg = &start[g * D * lanes_];
+			const float *zz = &zs[g * D * lanes_];
+			for(size_t i = 0; i < D; i++) zg[i * lanes_ + lane] = (float)s[i];
+			for(size_t i = 0; i < D; i++)
+			{
+				double acc = zz[i * lanes_ + lane];
+				for(size_t j = 0; j < D; j++) acc += AL_[i * D + j] * s[j];
+				t[i] = acc;
+			}
+			s.swap(t);
+		}
+
+		// 3. Outputs from the true start states
+		forGroups(G, [&](size_t g) { runGroup(g, x, y, L, &start[g * D * lanes_]); });
+
+		// The remainder after K*L samples runs sequentially from the end state
+		for(size_t i = 0; i < D; i++) state_[i] = (float)s[i];
+		const size_t done = K * L;
+		sosLanesScalar(sos_.data(), S, state_.data(), x + done, y + done, 1, len - done);
+	}
+
+private:
+	template <typename Fn>
+	void forGroups(size_t G, Fn fn)
+	{
+		if(threads_ <= 1 || G <= 1)
+		{
+			for(size_t g = 0; g < G; g++) fn(g);
+			return;
+		}
+		std::vector<std::thread> pool;
+		const size_t T = threads_ < G ? threads_ : G;
+		for(size_t t = 0; t < T; t++)
+		{
+			pool.emplace_back([&, t]() { for(size_t g = t; g < G; g += T) fn(g); });
+		}
+		for(std::thread &th : pool) th.join();
+	}
+
+	/*
+	 * Runs chunks g*W .. g*W+W-1 (W = lanes) through the cascade from state z
+	 * (lane-major, D rows of W), tile by tile through an interleaved scratch
+	 * so every lane kernel step is one vector load. y == nullptr only updates z.
+	 */
+	void runGroup(size_t g, const float *x, float *y, size_t L, float *z) const
+	{
+		switch(lanes_)
+		{
+		case 16: runLanes<16>(g, x, y, L, z); break;
+		case 8: runLanes<8>(g, x, y, L, z); break;
+		case 4: runLanes<4>(g, x, y, L, z); break;
+		default: runLanes<1>(g, x, y, L, z); break;
+		}
+	}
+
+	// Fixed W so the (de)interleaving loops compile to vector shuffles
+	template <size_t W>
+	void runLanes(size_t g, const float *x, float *y, size_t L, float *z) const
+	{
+		float tile[DSP_IIR_BLOCK_TILE * W];
+		const float *src[W];
+		float *dst[W];
+		for(size_t lane = 0; lane < W; lane++)
+		{
+			src[lane] = x + (g * W + lane) * L;
+			dst[lane] = y ? y + (g * W + lane) * L : nullptr;
+		}
+		for(size_t t0 = 0; t0 < L; t0 += DSP_IIR_BLOCK_TILE)
+		{
+			const size_t n = L - t0 < DSP_IIR_BLOCK_TILE ? L - t0 : DSP_IIR_BLOCK_TILE;
+			for(size_t i = 0; i < n; i++)
+			{
+				for(size_t lane = 0; lane < W; lane++) tile[i * W + lane] = src[lane][t0 + i];
+			}
+			kernel_(sos_.data(), sos_.size(), z, tile, tile, W, n);
+			if(!y) continue;
+			for(size_t i = 0; i < n; i++)
+			{
+				for(size_t lane = 0; lane < W; lane++) dst[lane][t0 + i] = tile[i * W + lane];
+			}
+		}
+	}
+
+	// A: one zero-input step of the cascade, column j = step of unit state e_j
+	void buildStepMatrix()
+	{
+		const size_t S = sos_.size(), D = 2 * S;
+		A_.assign(D * D, 0.0);
+		for(size_t j = 0; j < D; j++)
+		{
+			std::vector<double> z(D, 0.0);
+			z[j] = 1.0;
+			double x = 0.0;
+			for(size_t s = 0; s < S; s++)
+			{
+				const Biquad &q = sos_[s];
+				double yn = q.b0 * x + z[2 * s];
+				double z1 = q.b1 * x - q.a1 * yn + z[2 * s + 1];
+				double z2 = q.b2 * x - q.a2 * yn;
+				z[2 * s] = z1;
+				z[2 * s + 1] = z2;
+				x = yn;
+			}
+			for(size_t i = 0; i < D; i++) A_[i * D + j] = z[i];
+		}
+	}
+
+	// AL = A^L by repeated squaring
+	void buildPowerMatrix(size_t L)
+	{
+		const size_t D = 2 * sos_.size();
+		auto mul = [D](const std::vector<double> &P, const std::vector<double> &Q) {
+			std::vector<double> R(D * D, 0.0);
+			for(size_t i = 0; i < D; i++)
+				for(size_t k = 0; k < D; k++)
+					for(size_t j = 0; j < D; j++) R[i * D + j] += P[i * D + k] * Q[k * D + j];
+			return R;
+		};
+		std::vector<double> P = A_;
+		AL_.assign(D * D, 0.0);
+		for(size_t i = 0; i < D; i++) AL_[i * D + i] = 1.0;
+		for(size_t e = L; e; e >>= 1)
+		{
+			if(e & 1) AL_ = mul(AL_, P);
+			P = mul(P, P);
+		}
+		powL_ = L;
+	}
+
+	std::vector<Biquad> sos_;
+	std::vector<float> state_;		// z1, z2 per section, like SosCascade
+	std::vector<double> A_, AL_;	// Step matrix and its power L (row-major, 2S x 2S)
+	size_t powL_ = 0;
+	size_t lanes_ = 1;
+	unsigned threads_ = 1;
+	FirIsa isa_ = FIR_ISA_SCALAR;
+	SosLanesKernel kernel_ = sosLanesScalar;
+};
+
+} // namespace dsp
+
+#endif /* DSP_IIR_BLOCK_H_ */
@@ -0,0 +1,210 @@
+/*
+ * iir_design.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Butterworth and Chebyshev type I design, low-pass, high-pass, band-pass
+ *  and band-stop, straight to biquad sections (what butter()/cheby1() plus
+ *  tf2sos do in the Lab10 tutorials, without the transfer function round
+ *  trip that makes high orders unusable):
+ *    1. analog low-pass prototype poles for a cutoff of 1 rad/s,
+ *    2. frequency transformation to the requested type and band edges,
+ *    3. bilinear transform s = 2 (1 - z^-1) / (1 + z^-1),
+ *    4. conjugate pairs grouped into sections.
+ *  With prewarp the analog edges are 2 tan(w/2), so the digital filter hits
+ *  the requested edges exactly (-3 dB for Butterworth, -ripple for
+ *  Chebyshev); without it the analog edges equal w, which is what the
+ *  hand-derived bilinear transform of tutorial_1_iir.m does.
+ *
+ *  Frequencies are in rad/sample (wc = 2*pi*Fc/Fs), as in fir_design.h. The
+ *  order is the prototype order: band-pass and band-stop designs have twice
+ *  as many poles (order sections).
+ */
+
+#ifndef DSP_IIR_DESIGN_H_
+#define DSP_IIR_DESIGN_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <math.h>
+#include <complex>
+#include <vector>
+#include "iir.h"
+
+namespace dsp {
+
+/* Exported typedef -----------------------------------------------------------*/
+enum IirType { IIR_LOWPASS = 0, IIR_HIGHPASS, IIR_BANDPASS, IIR_BANDSTOP };
+
+enum IirFamily { IIR_BUTTERWORTH = 0, IIR_CHEBYSHEV1 };
+
+struct IirDesignSpec
+{
+	IirType type;
+	IirFamily family;
+	int order;			// Prototype order, 1..IIR_MAX_ORDER
+	float w1;			// Cutoff (LP/HP) or lower band edge (BP/BS), rad/sample
+	float w2;			// Upper band edge (BP/BS), unused otherwise
+	float rippleDb;		// Chebyshev passband ripple, unused for Butterworth
+	bool prewarp;
+};
+
+/* Exported define ------------------------------------------------------------*/
+#define IIR_MAX_ORDER	(32)
+
+/* Exported function prototypes -----------------------------------------------*/
+// |H(e^jw)| of one section
+inline double biquadMagnitude(const Biquad &q, double w)
+{
+	const cdouble z1 = std::polar(1.0, -w), z2 = z1 * z1;
+	return std::abs(((double)q.b0 + (double)q.b1 * z1 + (double)q.b2 * z2) / (1.0 + (double)q.a1 * z1 + (double)q.a2 * z2));
+}
+
+// max |H(e^jw)| of one section: coarse grid plus the pole angle, where a
+// resonance peaks
+inline double biquadPeak(const Biquad &q)
+{
+	double peak = fmax(biquadMagnitude(q, 0.0), biquadMagnitude(q, M_PI));
+	for(int i = 1; i < 64; i++) peak = fmax(peak, biquadMagnitude(q, M_PI * i / 64.0));
+	if(q.a2 > 0.0F)
+	{
+		const double c = -q.a1 / (2.0 * sqrt((double)q.a2));
+		if(c > -1.0 && c < 1.0) peak = fmax(peak, biquadMagnitude(q, acos(c)));
+	}
+	return peak;
+}
+
+// |H(e^jw)| of a cascade
+inline double sosMagnitude(const std::vector<Biquad> &sos, double w)
+{
+	double m = 1.0;
+	for(const Biquad &q : sos) m *= biquadMagnitude(q, w);
+	return m;
+}
+
+/*
+ * Designs spec into sos. Returns 1 on success, 0 for an invalid spec (order
+ * out of range, band edges not 0 < w1 < w2 < pi, ripple <= 0 for Chebyshev).
+ * Sections are ordered by pole radius (see factorsToSos()) and scaled so
+ * that none but the last peaks above 0 dB, which bounds the signal between
+ * sections (headroom for iir_q31.h).
+ */
+inline int iirDesign(const IirDesignSpec &spec, std::vector<Biquad> &sos)
+{
+	const int N = spec.order;
+	const bool band = spec.type == IIR_BANDPASS || spec.type == IIR_BANDSTOP;
+	if(N < 1 || N > IIR_MAX_ORDER) return 0;
+	if(spec.w1 <= 0.0F || spec.w1 >= (float)M_PI) return 0;
+	if(band && (spec.w2 <= spec.w1 || spec.w2 >= (float)M_PI)) return 0;
+	if(spec.family == IIR_CHEBYSHEV1 && spec.rippleDb <= 0.0F) return 0;
+
+	// 1. Prototype: left half-plane poles, cutoff 1 rad/s, no finite zeros
+	std::vector<cdouble> p;
+	double k = 1.0;
+	if(spec.family == IIR_CHEBYSHEV1)
+	{
+		const double eps = sqrt(pow(10.0, spec.rippleDb / 10.0) - 1.0);
+		const double mu = asinh(1.0 / eps) / N;
+		for(int i = 0; i < N; i++)
+		{
+			const double th = M_PI * (2.0 * i + 1.0) / (2.0 * N);
+			p.push_back(cdouble(-sinh(mu) * sin(th), cosh(mu) * cos(th)));
+		}
+		cdouble prod = 1.0;
+		for(const cdouble &pi : p) prod *= -pi;
+		k = prod.real();
+		// Even orders start the passband at the bottom of the ripple
+		if(!(N & 1)) k /= sqrt(1.0 + eps * eps);
+	}
+	else
+	{
+		for(int i = 0; i < N; i++) p.push_back(std::polar(1.0, M_PI * (2.0 * i + N + 1.0) / (2.0 * N)));
+	}
+
+	// 2. Analog band edges and frequency transformation
+	auto edge = [&](double w) { return spec.prewarp ? 2.0 * tan(w / 2.0) : w; };
+	const double W1 = edge(spec.w1), W2 = band ? edge(spec.w2) : 0.0;
+	std::vector<cdouble> za, pa;
+	switch(spec.type)
+	{
+	case IIR_HIGHPASS:
+	{
+		cdouble prod = 1.0;
+		for(const cdouble &pi : p)
+		{
+			pa.push_back(W1 / pi);
+			za.push_back(0.0);
+			prod *= -pi;
+		}
+		k /= prod.real();
+		break;
+	}
+	case IIR_BANDPASS:
+	case IIR_BANDSTOP:
+	{
+		const double W0 = sqrt(W1 * W2), BW = W2 - W1;
+		cdouble prod = 1.0;
+		for(const cdouble &pi : p)
+		{
+			// Roots of s^2 - c s + W0^2 with c = p*BW (BP) or BW/p (BS)
+			const cdouble c = spec.type == IIR_BANDPASS ? pi * BW : BW / pi;
+			const cdouble r = std::sqrt(c * c / 4.0 - W0 * W0);
+			pa.push_back(c / 2.0 + r);
+			pa.push_back(c / 2.0 - r);
+			if(spec.type == IIR_BANDPASS)
+			{
+				za.push_back(0.0);
+			}
+			else
+			{
+				za.push_back(cdouble(0.0, W0));
+				za.push_back(cdouble(0.0, -W0));
+				prod *= -pi;
+			}
+		}
+		k = spec.type == IIR_BANDPASS ? k * pow(BW, N) : k / prod.real();
+		break;
+	}
+	default:
+		for(const cdouble &pi : p) pa.push_back(W1 * pi);
+		k *= pow(W1, N);
+		break;
+	}
+
+	// 3. Bilinear transform, zeros at s = infinity go to z = -1
+	std::vector<cdouble> zd, pd;
+	cdouble num = 1.0, den = 1.0;
+	for(const cdouble &z : za)
+	{
+		zd.push_back((2.0 + z) / (2.0 - z));
+		num *= 2.0 - z;
+	}
+	for(const cdouble &q : pa)
+	{
+		pd.push_back((2.0 + q) / (2.0 - q));
+		den *= 2.0 - q;
+	}
+	while(zd.size() < pd.size()) zd.push_back(-1.0);
+	const double kd = k * (num / den).real();
+
+	// 4. Sections, every one but the last scaled to a peak gain of 1 (the
+	// last one takes the product, so the overall response is unchanged)
+	sos = zpkToSos(zd, pd, kd);
+	double carry = 1.0;
+	for(size_t s = 0; s < sos.size(); s++)
+	{
+		Biquad &q = sos[s];
+		const double g = s + 1 < sos.size() ? biquadPeak(q) : 1.0 / carry;
+		if(g <= 0.0) continue;
+		carry *= g;
+		q.b0 = (float)(q.b0 / g);
+		q.b1 = (float)(q.b1 / g);
+		q.b2 = (float)(q.b2 / g);
+	}
+	return 1;
+}
+
+} // namespace dsp
+
+#endif /* DSP_IIR_DESIGN_H_ */
@@ -0,0 +1,241 @@
+/*
+ * iir_q31.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Fixed-point biquad cascade for the Cortex-M4 audio path (lab5), plain C
+ *  and static inline like fir_q15.h. The same code compiles on the host and
+ *  is bit-exact there (only int32/int64 arithmetic, arithmetic right shifts
+ *  of negative values as done by GCC on ARM and x86), so
+ *  bench/bench_iir_q31.cpp is the model of what runs on the board.
+ *
+ *  Formats, per section in direct form I:
+ *    acc = b0*x[n] + b1*x[n-1] + b2*x[n-2] - a1*y[n-1] - a2*y[n-2] + e[n-1]
+ *    y[n] = sat32(acc >> 30),  e[n] = acc - (y[n] << 30)
+ *  - coefficients in Q2.30 (range [-2, 2), enough for any stable a1, a2),
+ *  - signals in Q1.30 (int16 input << 15, one bit of headroom for section
+ *    gain peaks), products in Q60 summed in a 64-bit accumulator (SMLAL),
+ *  - first-order error feedback: the fraction dropped when truncating acc
+ *    to y is added back on the next sample, so the requantization noise is
+ *    shaped by (1 - z^-1) and vanishes at DC. This is what makes low-cutoff
+ *    sections (poles next to z = 1, where the noise gain is huge) usable.
+ *  Headroom: the states are int32, |x|, |y| <= 2^31, so with the Q2.30
+ *  coefficients the products sum to at most sum|c| * 2^61. The accumulator
+ *  cannot overflow for any input when |b0|+|b1|+|b2|+|a1|+|a2| < 4 in every
+ *  section; BIQUAD_Q31_Init() counts the sections that break it. Keeping the
+ *  signals within int16 full scale does not buy more: a high-pass overshoots
+ *  a full-scale step and y only saturates at 2^31. A low-cutoff high-pass
+ *  (|a1|+|a2| ~ 3, |b| ~ 4) is made safe by scaling its b down by 4 and
+ *  taking the gain back with outShift = 2, an exact 2^outShift in the final
+ *  Q1.30 -> Q15 conversion (the section output loses 2 of its 30 bits).
+ *  Q2.30 has an absolute step of 2^-30: the b's of a very low cutoff low-pass
+ *  (b0 ~ 1.7e-8 at 2 Hz / 48 kHz) keep only a few significant bits, which
+ *  shows up as a small DC gain error, not as noise.
+ *  Silence: once x1/x2/y1/y2 are zero in every section, silent blocks are
+ *  skipped, which is bit-exact (a zero state with zero input gives y = 0 and
+ *  keeps e). A tail usually decays to exact zero by itself; so that a limit
+ *  cycle cannot keep it alive, state below BIQUAD_Q31_FLUSH is cleared after
+ *  a silent block. The threshold is tiny on purpose: with poles next to
+ *  z = 1 a small state with a slope (y1 != y2) still rings up to about
+ *  |y1 - y2| / pole angle, so clearing at an LSB-sized state would move the
+ *  output by several LSBs. Against a run without the flush, the next sound
+ *  can still come out one LSB apart.
+ */
+
+#ifndef DSP_IIR_Q31_H_
+#define DSP_IIR_Q31_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+#include "fir_q15.h"
+#include "silence.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported define ------------------------------------------------------------*/
+#define BIQUAD_Q31_SHIFT		(30)
+#define BIQUAD_Q31_COEFS		(5)		// b0, b1, b2, a1, a2 per section
+#define BIQUAD_Q31_STATE		(5)		// x1, x2, y1, y2, e per section
+#define BIQUAD_Q31_FLUSH		(8)		// Q1.30 state cleared after silence
+#define BIQUAD_Q31_MAX_OUT_SHIFT	(14)
+
+/* Exported typedef -----------------------------------------------------------*/
+typedef struct
+{
+	const int32_t *coefs;	// numStages x {b0, b1, b2, a1, a2} in Q2.30
+	int32_t *state;			// numStages x {x1, x2, y1, y2, e} (user memory)
+	uint8_t numStages;
+	uint8_t errorFeedback;	// 0: round to nearest instead (for comparison)
+	uint8_t outShift;		// Output gain 2^outShift, 0 .. BIQUAD_Q31_MAX_OUT_SHIFT
+	uint8_t idle;			// x1, x2, y1, y2 all zero in every section
+	SilenceStats_t stats;
+} BiquadQ31_t;
+
+/* Exported function prototypes -----------------------------------------------*/
+static inline int32_t Q31_Sat64(int64_t x)
+{
+	return (int32_t)(x > INT32_MAX ? INT32_MAX : (x < INT32_MIN ? INT32_MIN : x));
+}
+
+/*
+ * Quantizes numStages x {b0, b1, b2, a1, a2} floats (the dsp::Biquad layout,
+ * a0 = 1) to Q2.30. Returns the number of coefficients that saturated.
+ */
+static inline int BIQUAD_Q31_Quantize(const float *pSos, int32_t *pCoefs, uint8_t numStages)
+{
+	int nsat = 0;
+	for(uint16_t k = 0; k < (uint16_t)numStages * BIQUAD_Q31_COEFS; k++)
+	{
+		double v = floor((double)pSos[k] * (double)(1L << BIQUAD_Q31_SHIFT) + 0.5);
+		if(v > (double)INT32_MAX) { v = (double)INT32_MAX; nsat++; }
+		if(v < (double)INT32_MIN) { v = (double)INT32_MIN; nsat++; }
+		pCoefs[k] = (int32_t)v;
+	}
+	return nsat;
+}
+
+/*
+ * pState must hold BIQUAD_Q31_STATE*numStages words. The coefficients are
+ * not copied (a const table in flash is fine). Returns the number of
+ * sections whose accumulator could overflow (0 = safe for any input).
+ */
+static inline int BIQUAD_Q31_Init(BiquadQ31_t *pBq, const int32_t *pCoefs, int32_t *pState, uint8_t numStages)
+{
+	int unsafe = 0;
+	pBq->coefs = pCoefs;
+	pBq->state = pState;
+	pBq->numStages = numStages;
+	pBq->errorFeedback = 1;
+	pBq->outShift = 0;
+	pBq->idle = 1;
+	pBq->stats.blocks = pBq->stats.fastBlocks = pBq->stats.flushes = 0;
+	for(uint8_t s = 0; s < numStages; s++)
+	{
+		int64_t l1 = 0;
+		for(uint8_t k = 0; k < BIQUAD_Q31_COEFS; k++)
+		{
+			int64_t c = pCoefs[s * BIQUAD_Q31_COEFS + k];
+			l1 += c < 0 ? -c : c;
+			pState[s * BIQUAD_Q31_STATE + k] = 0;
+		}
+		// Q2.30 coefficients times int32 signals: sum|c| * 2^61 < 2^63
+		if(l1 >= 4LL << BIQUAD_Q31_SHIFT) unsafe++;
+	}
+	return unsafe;
+}
+
+static inline void BIQUAD_Q31_Reset(BiquadQ31_t *pBq)
+{
+	for(uint16_t k = 0; k < (uint16_t)pBq->numStages * BIQUAD_Q31_STATE; k++) pBq->state[k] = 0;
+	pBq->idle = 1;
+}
+
+// Clears x1, x2, y1, y2 (not e) if all are below BIQUAD_Q31_FLUSH, returns 1 then
+static inline int BIQUAD_Q31_Flush(BiquadQ31_t *pBq)
+{
+	int32_t *st = pBq->state;
+	for(uint8_t s = 0; s < pBq->numStages; s++, st += BIQUAD_Q31_STATE)
+	{
+		for(uint8_t k = 0; k < 4; k++)
+		{
+			if(st[k] >= BIQUAD_Q31_FLUSH || st[k] <= -BIQUAD_Q31_FLUSH) return 0;
+		}
+	}
+	st = pBq->state;
+	for(uint8_t s = 0; s < pBq->numStages; s++, st += BIQUAD_Q31_STATE)
+	{
+		st[0] = st[1] = st[2] = st[3] = 0;
+	}
+	pBq->stats.flushes++;
+	return 1;
+}
+
+// One int16 sample through every section, rounded and saturated to int16
+static inline int16_t BIQUAD_Q31_ProcessSample(BiquadQ31_t *pBq, int16_t x)
+{
+	const int32_t *c = pBq->coefs;
+	int32_t *st = pBq->state;
+	int32_t in = (int32_t)x << 15;	// Q15 -> Q1.30
+
+	pBq->idle = 0;
+	for(uint8_t s = 0; s < pBq->numStages; s++, c += BIQUAD_Q31_COEFS, st += BIQUAD_Q31_STATE)
+	{
+		int64_t acc;
+		int32_t y;
+		if(pBq->errorFeedback)
+		{
+			acc = (int64_t)st[4];
+		}
+		else
+		{
+			acc = 1LL << (BIQUAD_Q31_SHIFT - 1);
+		}
+		acc += (int64_t)c[0] * in;
+		acc += (int64_t)c[1] * st[0];
+		acc += (int64_t)c[2] * st[1];
+		acc -= (int64_t)c[3] * st[2];
+		acc -= (int64_t)c[4] * st[3];
+
+		y = Q31_Sat64(acc >> BIQUAD_Q31_SHIFT);
+		// Fraction dropped by the shift, 0 <= e < 2^30 (none after saturation)
+		st[4] = (y == (acc >> BIQUAD_Q31_SHIFT)) ? (int32_t)(acc & ((1LL << BIQUAD_Q31_SHIFT) - 1)) : 0;
+
+		st[1] = st[0];
+		st[0] = in;
+		st[3] = st[2];
+		st[2] = y;
+		in = y;
+	}
+	// Q1.30 -> Q15 times 2^outShift, round to nearest
+	const int sh = 15 - (pBq->outShift > BIQUAD_Q31_MAX_OUT_SHIFT ? BIQUAD_Q31_MAX_OUT_SHIFT : pBq->outShift);
+	return Q15_Sat64(((int64_t)in + (1L << (sh - 1))) >> sh);
+}
+
+// Same conventions as FIR_Q15_Process(), pIn and pOut may be the same buffer
+static inline void BIQUAD_Q31_Process(BiquadQ31_t *pBq, const int16_t *pIn, int16_t *pOut, uint16_t len, uint8_t inStride, uint8_t outStride)
+{
+	const int quiet = DSP_IsSilentQ15(pIn, len, inStride, 0);
+	pBq->stats.blocks++;
+	if(quiet && pBq->idle)
+	{
+		for(uint16_t n = 0; n < len; n++) pOut[n * outStride] = 0;
+		pBq->stats.fastBlocks++;
+		return;
+	}
+	for(uint16_t n = 0; n < len; n++)
+	{
+		pOut[n * outStride] = BIQUAD_Q31_ProcessSample(pBq, pIn[n * inStride]);
+	}
+	if(quiet) pBq->idle = (uint8_t)BIQUAD_Q31_Flush(pBq);
+}
+
+// Same contract as FIR_Q15_ProcessAudioBuffer(): Left filtered, copied to Right
+static inline void BIQUAD_Q31_ProcessAudioBuffer(BiquadQ31_t *pBq, int16_t *pBuffer, uint16_t len)
+{
+	const int quiet = DSP_IsSilentQ15(pBuffer, len / 2, 2, 0);
+	pBq->stats.blocks++;
+	if(quiet && pBq->idle)
+	{
+		for(uint16_t n = 0; n + 1 < len; n += 2) pBuffer[n + 1] = 0;
+		pBq->stats.fastBlocks++;
+		return;
+	}
+	for(uint16_t n = 0; n + 1 < len; n += 2)
+	{
+		pBuffer[n] = pBuffer[n + 1] = BIQUAD_Q31_ProcessSample(pBq, pBuffer[n]);
+	}
+	if(quiet) pBq->idle = (uint8_t)BIQUAD_Q31_Flush(pBq);
+}
+
+static inline int BIQUAD_Q31_IsIdle(const BiquadQ31_t *pBq) { return pBq->idle; }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_IIR_Q31_H_ */
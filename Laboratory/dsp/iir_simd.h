@@ -0,0 +1,340 @@
+/*
+ * iir_simd.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  The same biquad cascade on many channels at once. A biquad cannot be
+ *  vectorized along time (every output needs the previous one), but C
+ *  channels running the same sections are C independent recursions: with the
+ *  state stored channel-contiguous (structure of arrays),
+ *    z1[s][c], z2[s][c], c = 0..C-1
+ *  one vector instruction advances 4 (SSE2), 8 (AVX2+FMA) or 16 (AVX-512F)
+ *  channels by one step. The kernel is picked at runtime like fir_simd.h;
+ *  channels left over from the widest groups go to narrower kernels and the
+ *  scalar one.
+ *
+ *  Tolerance: the FMA kernels skip one rounding per multiply-add, so outputs
+ *  differ from SosCascade by a few ULP times the noise gain of the cascade.
+ */
+
+#ifndef DSP_IIR_SIMD_H_
+#define DSP_IIR_SIMD_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "iir.h"
+#include "fir_simd.h"
+
+namespace dsp {
+
+/* Exported typedef -----------------------------------------------------------*/
+/*
+ * Runs sections sos[0..S-1] over frames frames for the W channels that start
+ * at x, y and z. Samples of consecutive frames are C floats apart (the
+ * interleaved layout), state z[(2s)*C + c] = z1, z[(2s + 1)*C + c] = z2.
+ * Section-major: each section's coefficients and state stay in registers for
+ * the whole block, the next section reads the previous one's output from y.
+ */
+typedef void (*SosLanesKernel)(const Biquad *sos, size_t S, float *z, const float *x, float *y, size_t C, size_t frames);
+
+/* Exported function prototypes -----------------------------------------------*/
+// One channel
+inline void sosLanesScalar(const Biquad *sos, size_t S, float *z, const float *x, float *y, size_t C, size_t frames)
+{
+	for(size_t s = 0; s < S; s++)
+	{
+		const Biquad q = sos[s];
+		float z1 = z[2 * s * C], z2 = z[(2 * s + 1) * C];
+		const float *in = (s == 0) ? x : y;
+		for(size_t n = 0; n < frames; n++)
+		{
+			float xn = in[n * C];
+			float yn = q.b0 * xn + z1;
+			z1 = q.b1 * xn - q.a1 * yn + z2;
+			z2 = q.b2 * xn - q.a2 * yn;
+			y[n * C] = yn;
+		}
+		z[2 * s * C] = z1;
+		z[(2 * s + 1) * C] = z2;
+	}
+}
+
+#ifdef DSP_FIR_SIMD_X86
+// 4 channels
+__attribute__((target("sse2")))
+inline void sosLanesSse2(const Biquad *sos, size_t S, float *z, const float *x, float *y, size_t C, size_t frames)
+{
+	for(size_t s = 0; s < S; s++)
+	{
+		const __m128 b0 = _mm_set1_ps(sos[s].b0), b1 = _mm_set1_ps(sos[s].b1), b2 = _mm_set1_ps(sos[s].b2);
+		const __m128 a1 = _mm_set1_ps(sos[s].a1), a2 = _mm_set1_ps(sos[s].a2);
+		__m128 z1 = _mm_loadu_ps(z + 2 * s * C), z2 = _mm_loadu_ps(z + (2 * s + 1) * C);
+		const float *in = (s == 0) ? x : y;
+		for(size_t n = 0; n < frames; n++)
+		{
+			__m128 xn = _mm_loadu_ps(in + n * C);
+			__m128 yn = _mm_add_ps(_mm_mul_ps(b0, xn), z1);
+			z1 = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(b1, xn), z2), _mm_mul_ps(a1, yn));
+			z2 = _mm_sub_ps(_mm_mul_ps(b2, xn), _mm_mul_ps(a2, yn));
+			_mm_storeu_ps(y + n * C, yn);
+		}
+		_mm_storeu_ps(z + 2 * s * C, z1);
+		_mm_storeu_ps(z + (2 * s + 1) * C, z2);
+	}
+}
+
+// 8 channels
+__attribute__((target("avx2,fma")))
+inline void sosLanesAvx2(const Biquad *sos, size_t S, float *z, const float *x, float *y, size_t C, size_t frames)
+{
+	for(size_t s = 0; s < S; s++)
+	{
+		const __m256 b0 = _mm256_set1_ps(sos[s].b0), b1 = _mm256_set1_ps(sos[s].b1), b2 = _mm256_set1_ps(sos[s].b2);
+		const __m256 a1 = _mm256_set1_ps(sos[s].a1), a2 = _mm256_set1_ps(sos[s].a2);
+		__m256 z1 = _mm256_loadu_ps(z + 2 * s * C), z2 = _mm256_loadu_ps(z + (2 * s + 1) * C);
+		const float *in = (s == 0) ? x : y;
+		for(size_t n = 0; n < frames; n++)
+		{
+			__m256 xn = _mm256_loadu_ps(in + n * C);
+			__m256 yn = _mm256_fmadd_ps(b0, xn, z1);
+			// b1*x + z2 is off the recursive path, only -a1*y waits for yn
+			z1 = _mm256_fnmadd_ps(a1, yn, _mm256_fmadd_ps(b1, xn, z2));
+			z2 = _mm256_fnmadd_ps(a2, yn, _mm256_mul_ps(b2, xn));
+			_mm256_storeu_ps(y + n * C, yn);
+		}
+		_mm256_storeu_ps(z + 2 * s * C, z1);
+		_mm256_storeu_ps(z + (2 * s + 1) * C, z2);
+	}
+}
+
+// 16 channels
+__attribute__((target("avx512f")))
+inline void sosLanesAvx512(const Biquad *sos, size_t S, float *z, const float *x, float *y, size_t C, size_t frames)
+{
+	for(size_t s = 0; s < S; s++)
+	{
+		const __m512 b0 = _mm512_set1_ps(sos[s].b0), b1 = _mm512_set1_ps(sos[s].b1), b2 = _mm512_set1_ps(sos[s].b2);
+		const __m512 a1 = _mm512_set1_ps(sos[s].a1), a2 = _mm512_set1_ps(sos[s].a2);
+		__m512 z1 = _mm512_loadu_ps(z + 2 * s * C), z2 = _mm512_loadu_ps(z + (2 * s + 1) * C);
+		const float *in = (s == 0) ? x : y;
+		for(size_t n = 0; n < frames; n++)
+		{
+			__m512 xn = _mm512_loadu_ps(in + n * C);
+			__m512 yn = _mm512_fmadd_ps(b0, xn, z1);
+			z1 = _mm512_fnmadd_ps(a1, yn, _mm512_fmadd_ps(b1, xn, z2));
+			z2 = _mm512_fnmadd_ps(a2, yn, _mm512_mul_ps(b2, xn));
+			_mm512_storeu_ps(y + n * C, yn);
+		}
+		_mm512_storeu_ps(z + 2 * s * C, z1);
+		_mm512_storeu_ps(z + (2 * s + 1) * C, z2);
+	}
+}
+#endif /* DSP_FIR_SIMD_X86 */
+
+/* Exported define ------------------------------------------------------------*/
+#define DSP_SOS_FADE_CHUNK	(64)		// Frames of the old-coefficient output kept at once
+#ifndef DSP_SOS_FADE_FRAMES
+#define DSP_SOS_FADE_FRAMES	(512)		// Default crossfade of update(), about 10 ms at 48 kHz
+#endif
+
+/* Exported class -------------------------------------------------------------*/
+/*
+ * SosCascade for C channels of interleaved frames, same sections on every
+ * channel and independent state per channel. Channels are split in groups of
+ * 16/8/4 lanes (as far as the ISA allows) and the rest run one by one.
+ */
+class MultiChannelSos
+{
+public:
+	MultiChannelSos() { setIsa(firDetectIsa()); }
+	MultiChannelSos(const std::vector<Biquad> &sos, size_t numChannels, size_t maxFrames = 256) : MultiChannelSos()
+	{
+		init(sos, numChannels, maxFrames);
+	}
+
+	// Transfer function as printed by the MATLAB scripts: b0..bM and a1..aN
+	template <typename T>
+	MultiChannelSos(const T *b, size_t nb, const T *a, size_t na, size_t numChannels)
+		: MultiChannelSos(tfToSos(b, nb, a, na), numChannels) {}
+
+	// maxFrames: largest processInterleaved() block without splitting
+	void init(const std::vector<Biquad> &sos, size_t numChannels, size_t maxFrames = 256)
+	{
+		sos_ = sos;
+		old_ = sos;
+		C_ = numChannels;
+		fadeBuf_.assign(DSP_SOS_FADE_CHUNK * C_, 0.0F);
+		scratch_.assign(maxFrames * C_, 0.0F);
+		fading_ = false;
+		reset();
+	}
+
+	// Force a kernel width, e.g. to benchmark or to compare against scalar
+	void setIsa(FirIsa isa) { isa_ = isa; }
+
+	void reset()
+	{
+		state_.assign(2 * sos_.size() * C_, 0.0F);
+		oldState_.assign(state_.size(), 0.0F);
+		fading_ = false;
+		idle_ = true;
+	}
+
+	// State flushed to zero after a silent block (0: never flush)
+	void setFlushThreshold(float threshold) { flush_ = threshold; }
+
+	/*
+	 * Zipper-free coefficient change, safe in the audio loop (no allocation,
+	 * same number of sections as init()). From the next process() call the
+	 * old and the new sections both run, from the same state, and the output
+	 * is crossfaded linearly over setFadeFrames() frames, whatever the block
+	 * size (it may span many blocks); then only the new sections run. The new
+	 * sections start from a state built by the old ones, so a fade much
+	 * shorter than their impulse response (e.g. one 16-frame Lab9 block) only
+	 * takes a few dB off the click, see bench/bench_param_slot.cpp.
+	 * crossfade = false switches at once. A change during a fade keeps the
+	 * old sections and the fade position, the newest sections take over.
+	 * Returns false (and changes nothing) on a section count mismatch.
+	 */
+	bool update(const Biquad *sos, size_t numSections, bool crossfade = true)
+	{
+		if(numSections != sos_.size()) return false;
+		if(!fading_)
+		{
+			std::copy(sos_.begin(), sos_.end(), old_.begin());
+			std::copy(state_.begin(), state_.end(), oldState_.begin());
+			fadePos_ = 0;
+		}
+		std::copy(sos, sos + numSections, sos_.begin());
+		fading_ = crossfade && fadeFrames_ > 0;
+		return true;
+	}
+
+	// Crossfade length of update() in frames (0: switch at once)
+	void setFadeFrames(size_t frames) { fadeFrames_ = frames; }
+	size_t fadeFrames() const { return fadeFrames_; }
+
+	FirIsa isa() const { return isa_; }
+	size_t numChannels() const { return C_; }
+	size_t numSections() const { return sos_.size(); }
+	const std::vector<Biquad> &sections() const { return sos_; }
+	const SilenceStats_t &silenceStats() const { return stats_; }
+
+	// x and y are frames x C interleaved floats, may be the same buffer. A
+	// silent block into a zero state is skipped (see silence.h).
+	void process(const float *x, float *y, size_t frames)
+	{
+		if(!sos_.size())
+		{
+			if(x != y) memmove(y, x, frames * C_ * sizeof(float));
+			return;
+		}
+		stats_.blocks++;
+		const bool quiet = DSP_IsSilentF32(x, frames * C_, 0.0F);
+		if(quiet && idle_)
+		{
+			// Old and new sections alike give zeros, nothing left to fade
+			memset(y, 0, frames * C_ * sizeof(float));
+			fading_ = false;
+			stats_.fastBlocks++;
+			return;
+		}
+		if(!fading_ || !frames) run(sos_.data(), state_.data(), x, y, frames);
+		else fade(x, y, frames);
+		// During a fade the old sections' state still counts
+		idle_ = quiet && !fading_ && DSP_FlushF32(state_.data(), state_.size(), flush_);
+		stats_.flushes += idle_;
+	}
+
+	// buffer holds frames x C int16 samples, filtered in place (clipped)
+	void processInterleaved(int16_t *buffer, size_t frames)
+	{
+		const size_t len = frames * C_;
+		if(idle_ && sos_.size() && DSP_IsSilentQ15(buffer, len, 1, 0))
+		{
+			// Zeros in, zeros out: not even the conversions
+			stats_.blocks++;
+			stats_.fastBlocks++;
+			fading_ = false;
+			return;
+		}
+		const size_t maxFrames = C_ ? scratch_.size() / C_ : 0;
+		while(frames && maxFrames)
+		{
+			const size_t n = frames < maxFrames ? frames : maxFrames;
+			for(size_t i = 0; i < n * C_; i++) scratch_[i] = toFloat(buffer[i]);
+			process(scratch_.data(), scratch_.data(), n);
+			for(size_t i = 0; i < n * C_; i++) buffer[i] = toInt16(scratch_[i]);
+			buffer += n * C_;
+			frames -= n;
+		}
+	}
+
+private:
+	// The old and the new sections side by side until the fade is over, the
+	// rest of the block with the new ones only
+	void fade(const float *x, float *y, size_t frames)
+	{
+		const float step = 1.0F / (float)fadeFrames_;
+		size_t n0 = 0;
+		while(n0 < frames && fading_)
+		{
+			size_t m = frames - n0 < DSP_SOS_FADE_CHUNK ? frames - n0 : DSP_SOS_FADE_CHUNK;
+			if(m > fadeFrames_ - fadePos_) m = fadeFrames_ - fadePos_;
+			const float *xn = x + n0 * C_;
+			float *yn = y + n0 * C_;
+			// Old sections first: in place, the new pass overwrites x
+			run(old_.data(), oldState_.data(), xn, fadeBuf_.data(), m);
+			run(sos_.data(), state_.data(), xn, yn, m);
+			for(size_t i = 0; i < m; i++)
+			{
+				const float g = (float)(fadePos_ + i + 1) * step;
+				for(size_t c = 0; c < C_; c++)
+				{
+					const float yo = fadeBuf_[i * C_ + c];
+					yn[i * C_ + c] = yo + g * (yn[i * C_ + c] - yo);
+				}
+			}
+			fadePos_ += m;
+			n0 += m;
+			fading_ = fadePos_ < fadeFrames_;
+		}
+		if(n0 < frames) run(sos_.data(), state_.data(), x + n0 * C_, y + n0 * C_, frames - n0);
+	}
+
+	void run(const Biquad *sos, float *z, const float *x, float *y, size_t frames) const
+	{
+		const size_t S = sos_.size();
+		size_t c = 0;
+#ifdef DSP_FIR_SIMD_X86
+		if(isa_ >= FIR_ISA_AVX512) for(; c + 16 <= C_; c += 16) sosLanesAvx512(sos, S, z + c, x + c, y + c, C_, frames);
+		if(isa_ >= FIR_ISA_AVX2) for(; c + 8 <= C_; c += 8) sosLanesAvx2(sos, S, z + c, x + c, y + c, C_, frames);
+		if(isa_ >= FIR_ISA_SSE2) for(; c + 4 <= C_; c += 4) sosLanesSse2(sos, S, z + c, x + c, y + c, C_, frames);
+#endif
+		for(; c < C_; c++) sosLanesScalar(sos, S, z + c, x + c, y + c, C_, frames);
+	}
+
+	std::vector<Biquad> sos_;
+	std::vector<Biquad> old_;		// Sections being faded out
+	std::vector<float> state_;		// z1/z2 rows of C floats per section
+	std::vector<float> oldState_;	// State of old_, forked from state_ by update()
+	std::vector<float> fadeBuf_;	// DSP_SOS_FADE_CHUNK frames of old_ output
+	std::vector<float> scratch_;	// Interleaved float copy of an int16 block, maxFrames x C
+	size_t C_ = 1;
+	FirIsa isa_ = FIR_ISA_SCALAR;
+	bool fading_ = false;
+	size_t fadeFrames_ = DSP_SOS_FADE_FRAMES;
+	size_t fadePos_ = 0;			// Frames of the current fade done
+	float flush_ = DSP_STATE_FLUSH;
+	bool idle_ = true;				// state_ is all zero
+	SilenceStats_t stats_ = {0, 0, 0};
+};
+
+} // namespace dsp
+
+#endif /* DSP_IIR_SIMD_H_ */
@@ -0,0 +1,320 @@
+/*
+ * multichannel.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Multichannel processing of interleaved frames (L/R AudioBuffer, N-channel
+ *  captures) with independent filter state per channel:
+ *  - deinterleave()/interleave(): int16 interleaved <-> float planar.
+ *  - MultiChannel<Filter>: one filter object per channel, run over planar
+ *    buffers (different taps per channel, any filter with a block process()).
+ *  - MultiChannelFir: the same taps on every channel, with the delay line
+ *    stored frame by frame so the inner loop runs across channels and the
+ *    compiler vectorizes it (C = 2, 4, 8 are compiled as fixed widths).
+ *    Symmetric taps are folded as in FirFilter.
+ *  Both size their scratch buffers up front (maxFrames): processInterleaved()
+ *  never allocates in the audio loop, longer blocks are split.
+ */
+
+#ifndef DSP_MULTICHANNEL_H_
+#define DSP_MULTICHANNEL_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <utility>
+#include <vector>
+#include "fir.h"
+#include "silence.h"
+
+namespace dsp {
+
+/* Exported function prototypes -----------------------------------------------*/
+// in: frames x C interleaved int16, planar[c]: frames floats
+inline void deinterleave(const int16_t *in, float *const *planar, size_t C, size_t frames)
+{
+	for(size_t n = 0; n < frames; n++)
+	{
+		for(size_t c = 0; c < C; c++) planar[c][n] = toFloat(in[n * C + c]);
+	}
+}
+
+// Clips to [-1,1] like the sketches do before converting back to int16
+inline void interleave(const float *const *planar, int16_t *out, size_t C, size_t frames)
+{
+	for(size_t n = 0; n < frames; n++)
+	{
+		for(size_t c = 0; c < C; c++) out[n * C + c] = toInt16(planar[c][n]);
+	}
+}
+
+/* Exported class -------------------------------------------------------------*/
+/*
+ * One Filter per channel over planar scratch buffers. Filter needs
+ * process(const float *x, float *y, size_t len), e.g. FirFilter, FirEngine.
+ */
+template <typename Filter>
+class MultiChannel
+{
+public:
+	explicit MultiChannel(size_t numChannels = 2, size_t maxFrames = 256)
+		: filters_(numChannels), planar_(numChannels), ptrs_(numChannels)
+	{
+		for(size_t c = 0; c < numChannels; c++) planar_[c].resize(maxFrames);
+		updatePtrs();
+	}
+
+	// ptrs_ points into planar_: a copy or move gets its own
+	MultiChannel(const MultiChannel &o) : filters_(o.filters_), planar_(o.planar_), ptrs_(o.ptrs_.size()) { updatePtrs(); }
+	MultiChannel(MultiChannel &&o) : filters_(std::move(o.filters_)), planar_(std::move(o.planar_)), ptrs_(std::move(o.ptrs_))
+	{
+		updatePtrs();
+	}
+
+	MultiChannel &operator=(MultiChannel o)
+	{
+		filters_.swap(o.filters_);
+		planar_.swap(o.planar_);
+		ptrs_.swap(o.ptrs_);
+		updatePtrs();
+		return *this;
+	}
+
+	size_t numChannels() const { return filters_.size(); }
+	Filter &channel(size_t c) { return filters_[c]; }
+
+	void processPlanar(float *const *x, float *const *y, size_t frames)
+	{
+		for(size_t c = 0; c < filters_.size(); c++) filters_[c].process(x[c], y[c], frames);
+	}
+
+	// buffer holds frames x numChannels interleaved samples, filtered in place
+	void processInterleaved(int16_t *buffer, size_t frames)
+	{
+		const size_t C = filters_.size(), maxFrames = planar_.empty() ? 0 : planar_[0].size();
+		while(frames && maxFrames)
+		{
+			const size_t n = frames < maxFrames ? frames : maxFrames;
+			deinterleave(buffer, ptrs_.data(), C, n);
+			processPlanar(ptrs_.data(), ptrs_.data(), n);
+			interleave(ptrs_.data(), buffer, C, n);
+			buffer += n * C;
+			frames -= n;
+		}
+	}
+
+private:
+	void updatePtrs()
+	{
+		for(size_t c = 0; c < planar_.size(); c++) ptrs_[c] = planar_[c].data();
+	}
+
+	std::vector<Filter> filters_;
+	std::vector<std::vector<float>> planar_;	// Per channel scratch
+	std::vector<float *> ptrs_;
+};
+
+/*
+ * Same FIR on C channels in one pass. The mirrored delay line holds whole
+ * frames, state[(pos + k)*C + c] = x_c[n-k], so
+ *   y_c[n] = sum_k h[k] * state[(pos + k)*C + c]
+ * is, for each k, one multiply-add over C contiguous lanes. With symmetric
+ * taps the frames k and M-1-k are added first (half the multiplies).
+ */
+class MultiChannelFir
+{
+public:
+	MultiChannelFir() {}
+	MultiChannelFir(const float *h, size_t numTaps, size_t numChannels, size_t maxFrames = 256)
+	{
+		init(h, numTaps, numChannels, maxFrames);
+	}
+
+	// maxFrames: largest processInterleaved() block without splitting
+	void init(const float *h, size_t numTaps, size_t numChannels, size_t maxFrames = 256)
+	{
+		h_.assign(h, h + numTaps);
+		symmetric_ = FirFilter::isSymmetric(h, numTaps);
+		C_ = numChannels;
+		scratch_.assign(maxFrames * numChannels, 0.0F);
+		reset();
+	}
+
+	void reset()
+	{
+		state_.assign(2 * h_.size() * C_, 0.0F);
+		pos_ = 0;
+		zeroFrames_ = h_.size();
+	}
+
+	size_t numChannels() const { return C_; }
+	FirStructure structure() const { return symmetric_ ? FIR_SYMMETRIC : FIR_DIRECT; }
+	const SilenceStats_t &silenceStats() const { return stats_; }
+
+	// x and y are frames x C interleaved floats, may be the same buffer. Once
+	// M silent frames have gone in the delay line is all zero, and further
+	// silent blocks are skipped (see silence.h).
+	void process(const float *x, float *y, size_t frames)
+	{
+		stats_.blocks++;
+		const bool quiet = DSP_IsSilentF32(x, frames * C_, 0.0F);
+		if(quiet && zeroFrames_ >= h_.size())
+		{
+			memset(y, 0, frames * C_ * sizeof(float));
+			stats_.fastBlocks++;
+			return;
+		}
+		zeroFrames_ = quiet ? zeroFrames_ + frames : 0;
+		switch(C_)
+		{
+		case 1: run<1>(x, y, frames); break;
+		case 2: run<2>(x, y, frames); break;
+		case 4: run<4>(x, y, frames); break;
+		case 8: run<8>(x, y, frames); break;
+		default: runAny(x, y, frames); break;
+		}
+	}
+
+	/*
+	 * True multichannel AudioBuffer processing: buffer holds frames x C int16
+	 * samples (len = bytesRead/2 entries for stereo means len/2 frames),
+	 * every channel is filtered with its own state, clipped and written back.
+	 */
+	void processInterleaved(int16_t *buffer, size_t frames)
+	{
+		const size_t len = frames * C_;
+		if(zeroFrames_ >= h_.size() && DSP_IsSilentQ15(buffer, len, 1, 0))
+		{
+			// Zeros in, zeros out: not even the conversions
+			stats_.blocks++;
+			stats_.fastBlocks++;
+			return;
+		}
+		const size_t maxFrames = C_ ? scratch_.size() / C_ : 0;
+		while(frames && maxFrames)
+		{
+			const size_t n = frames < maxFrames ? frames : maxFrames;
+			for(size_t i = 0; i < n * C_; i++) scratch_[i] = toFloat(buffer[i]);
+			process(scratch_.data(), scratch_.data(), n);
+			for(size_t i = 0; i < n * C_; i++) buffer[i] = toInt16(scratch_[i]);
+			buffer += n * C_;
+			frames -= n;
+		}
+	}
+
+private:
+	void advance()
+	{
+		const size_t M = h_.size();
+		pos_ = (pos_ == 0) ? M - 1 : pos_ - 1;
+	}
+
+	// Writes the new frame at pos and pos + M
+	void pushFrame(const float *frame)
+	{
+		const size_t M = h_.size();
+		advance();
+		memcpy(&state_[pos_ * C_], frame, C_ * sizeof(float));
+		memcpy(&state_[(pos_ + M) * C_], frame, C_ * sizeof(float));
+	}
+
+	// y for channels c0..c0+W-1 of the newest frame
+	template <size_t W>
+	void dotLanes(size_t c0, float *y) const
+	{
+		const size_t M = h_.size();
+		float acc[W] = {};
+		const float *w = &state_[pos_ * C_ + c0];
+		if(symmetric_)
+		{
+			for(size_t k = 0; k < M / 2; k++)
+			{
+				const float hk = h_[k], *a = &w[k * C_], *b = &w[(M - 1 - k) * C_];
+				for(size_t c = 0; c < W; c++) acc[c] += hk * (a[c] + b[c]);
+			}
+			if(M & 1)
+			{
+				for(size_t c = 0; c < W; c++) acc[c] += h_[M / 2] * w[(M / 2) * C_ + c];
+			}
+		}
+		else
+		{
+			for(size_t k = 0; k < M; k++, w += C_)
+			{
+				const float hk = h_[k];
+				for(size_t c = 0; c < W; c++) acc[c] += hk * w[c];
+			}
+		}
+		for(size_t c = 0; c < W; c++) y[c0 + c] = acc[c];
+	}
+
+	template <size_t C>
+	void run(const float *x, float *y, size_t frames)
+	{
+		const size_t M = h_.size();
+		if(!M) { if(x != y) memmove(y, x, frames * C * sizeof(float)); return; }
+		for(size_t n = 0; n < frames; n++)
+		{
+			advance();
+			float *s0 = &state_[pos_ * C];
+			float *s1 = &state_[(pos_ + M) * C];
+			for(size_t c = 0; c < C; c++) s0[c] = s1[c] = x[n * C + c];
+
+			float acc[C] = {};
+			if(symmetric_)
+			{
+				for(size_t k = 0; k < M / 2; k++)
+				{
+					const float hk = h_[k], *a = &s0[k * C], *b = &s0[(M - 1 - k) * C];
+					for(size_t c = 0; c < C; c++) acc[c] += hk * (a[c] + b[c]);
+				}
+				if(M & 1)
+				{
+					for(size_t c = 0; c < C; c++) acc[c] += h_[M / 2] * s0[(M / 2) * C + c];
+				}
+			}
+			else
+			{
+				const float *w = s0;
+				for(size_t k = 0; k < M; k++, w += C)
+				{
+					const float hk = h_[k];
+					for(size_t c = 0; c < C; c++) acc[c] += hk * w[c];
+				}
+			}
+			for(size_t c = 0; c < C; c++) y[n * C + c] = acc[c];
+		}
+	}
+
+	void runAny(const float *x, float *y, size_t frames)
+	{
+		if(h_.empty()) { if(x != y) memmove(y, x, frames * C_ * sizeof(float)); return; }
+		for(size_t n = 0; n < frames; n++)
+		{
+			pushFrame(&x[n * C_]);
+
+			// Split the channels in groups of fixed width (e.g. 6 = 4 + 2)
+			float *yn = &y[n * C_];
+			size_t c0 = 0;
+			for(; c0 + 8 <= C_; c0 += 8) dotLanes<8>(c0, yn);
+			if(c0 + 4 <= C_) { dotLanes<4>(c0, yn); c0 += 4; }
+			if(c0 + 2 <= C_) { dotLanes<2>(c0, yn); c0 += 2; }
+			if(c0 < C_) dotLanes<1>(c0, yn);
+		}
+	}
+
+	std::vector<float> h_;
+	std::vector<float> state_;	// Mirrored delay line of frames, 2*M*C samples
+	std::vector<float> scratch_;	// Interleaved float copy of an int16 block, maxFrames x C
+	bool symmetric_ = false;	// Folded linear-phase structure
+	size_t C_ = 1;
+	size_t pos_ = 0;			// Frame position of x[n] inside the delay line
+	size_t zeroFrames_ = 0;		// Silent frames in a row at the input
+	SilenceStats_t stats_ = {};
+};
+
+} // namespace dsp
+
+#endif /* DSP_MULTICHANNEL_H_ */
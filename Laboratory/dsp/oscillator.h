@@ -0,0 +1,341 @@
+/*
+ * oscillator.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Bank of recursive sine oscillators for test tones and additive synthesis,
+ *  much faster than sinf() per sample. Theory/SineWaveSynthesis uses the
+ *  resonator
+ *    y[n] = sin(w) x[n-1] + 2 cos(w) y[n-1] - y[n-2]
+ *  which is marginally stable: in float its amplitude random-walks and it
+ *  cannot change frequency without a jump (y[n-1], y[n-2] only describe a
+ *  sine for the old w). The bank uses the coupled form instead, a rotation of
+ *  the (cos, sin) pair of every oscillator:
+ *    c[n+1] = c[n] cos(w) - s[n] sin(w)
+ *    s[n+1] = s[n] cos(w) + c[n] sin(w),   output amp * s[n]
+ *  - a new w only changes the rotation, the phase stays continuous,
+ *  - the radius c^2 + s^2 is known to be 1, so the amplitude error is
+ *    corrected every tile (DSP_OSC_TILE samples) by one Newton step,
+ *    g = (3 - c^2 - s^2) / 2; the error cannot build up past one tile and
+ *    stays around 1e-5 (the float resonator is past 1e-4 within minutes).
+ *  What remains is the frequency error of cos(w), sin(w) rounded to float
+ *  (a phase drift of about 1e-7 rad per sample at worst).
+ *
+ *  Structure of arrays (c[], s[], cos w[], sin w[], amp[] contiguous), one
+ *  oscillator per lane, 4/8/16 lanes picked at runtime like fir_simd.h.
+ */
+
+#ifndef DSP_OSCILLATOR_H_
+#define DSP_OSCILLATOR_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "fir_simd.h"
+
+namespace dsp {
+
+/* Exported define ------------------------------------------------------------*/
+#define DSP_OSC_TILE	(256)		// Frames per kernel call, renormalized after each
+#define DSP_OSC_ALIGN	(16)		// Oscillator count padding (widest lane count)
+
+/* Exported typedef -----------------------------------------------------------*/
+/*
+ * Advances oscillators [0, num) (num a multiple of the kernel width W) by
+ * frames samples, then renormalizes them.
+ *  - out != nullptr: out[n*stride + i] = amp[i] * s[i] at frame n (render),
+ *  - otherwise acc[n*W + lane] += amp * s summed over the groups of W (mix;
+ *    the caller adds the W lanes).
+ */
+typedef void (*OscKernel)(float *c, float *s, const float *cw, const float *sw, const float *amp, size_t num,
+		float *out, size_t stride, float *acc, size_t frames);
+
+/* Exported function prototypes -----------------------------------------------*/
+inline void oscKernelScalar(float *c, float *s, const float *cw, const float *sw, const float *amp, size_t num,
+		float *out, size_t stride, float *acc, size_t frames)
+{
+	for(size_t i = 0; i < num; i++)
+	{
+		float ci = c[i], si = s[i];
+		const float r = cw[i], q = sw[i], a = amp[i];
+		for(size_t n = 0; n < frames; n++)
+		{
+			if(out) out[n * stride + i] = a * si;
+			else acc[n] += a * si;
+			const float cn = ci * r - si * q;
+			si = si * r + ci * q;
+			ci = cn;
+		}
+		const float g = 1.5F - 0.5F * (ci * ci + si * si);
+		c[i] = ci * g;
+		s[i] = si * g;
+	}
+}
+
+#ifdef DSP_FIR_SIMD_X86
+/*
+ * The vector kernels advance G groups of W oscillators side by side: one
+ * rotation step is a multiply and an FMA deep, so a single group would
+ * leave the FP units idle waiting on the previous sample.
+ */
+template <int G>
+__attribute__((target("sse2")))
+inline void oscGroupsSse2(float *c, float *s, const float *cw, const float *sw, const float *amp,
+		float *out, size_t stride, float *acc, size_t frames)
+{
+	__m128 ci[G], si[G], r[G], q[G], a[G];
+#pragma GCC unroll 4
+	for(int g = 0; g < G; g++)
+	{
+		ci[g] = _mm_loadu_ps(c + 4 * g);
+		si[g] = _mm_loadu_ps(s + 4 * g);
+		r[g] = _mm_loadu_ps(cw + 4 * g);
+		q[g] = _mm_loadu_ps(sw + 4 * g);
+		a[g] = _mm_loadu_ps(amp + 4 * g);
+	}
+	for(size_t n = 0; n < frames; n++)
+	{
+		__m128 sum = _mm_setzero_ps();
+#pragma GCC unroll 4
+		for(int g = 0; g < G; g++)
+		{
+			const __m128 y = _mm_mul_ps(a[g], si[g]);
+			if(out) _mm_storeu_ps(out + n * stride + 4 * g, y);
+			else sum = _mm_add_ps(sum, y);
+			const __m128 cn = _mm_sub_ps(_mm_mul_ps(ci[g], r[g]), _mm_mul_ps(si[g], q[g]));
+			si[g] = _mm_add_ps(_mm_mul_ps(si[g], r[g]), _mm_mul_ps(ci[g], q[g]));
+			ci[g] = cn;
+		}
+		if(!out) _mm_storeu_ps(acc + n * 4, _mm_add_ps(_mm_loadu_ps(acc + n * 4), sum));
+	}
+#pragma GCC unroll 4
+	for(int g = 0; g < G; g++)
+	{
+		const __m128 r2 = _mm_add_ps(_mm_mul_ps(ci[g], ci[g]), _mm_mul_ps(si[g], si[g]));
+		const __m128 k = _mm_sub_ps(_mm_set1_ps(1.5F), _mm_mul_ps(_mm_set1_ps(0.5F), r2));
+		_mm_storeu_ps(c + 4 * g, _mm_mul_ps(ci[g], k));
+		_mm_storeu_ps(s + 4 * g, _mm_mul_ps(si[g], k));
+	}
+}
+
+__attribute__((target("sse2")))
+inline void oscKernelSse2(float *c, float *s, const float *cw, const float *sw, const float *amp, size_t num,
+		float *out, size_t stride, float *acc, size_t frames)
+{
+	size_t i = 0;
+	for(; i + 16 <= num; i += 16) oscGroupsSse2<4>(c + i, s + i, cw + i, sw + i, amp + i, out ? out + i : out, stride, acc, frames);
+	for(; i < num; i += 4) oscGroupsSse2<1>(c + i, s + i, cw + i, sw + i, amp + i, out ? out + i : out, stride, acc, frames);
+}
+
+template <int G>
+__attribute__((target("avx2,fma")))
+inline void oscGroupsAvx2(float *c, float *s, const float *cw, const float *sw, const float *amp,
+		float *out, size_t stride, float *acc, size_t frames)
+{
+	__m256 ci[G], si[G], r[G], q[G], a[G];
+#pragma GCC unroll 4
+	for(int g = 0; g < G; g++)
+	{
+		ci[g] = _mm256_loadu_ps(c + 8 * g);
+		si[g] = _mm256_loadu_ps(s + 8 * g);
+		r[g] = _mm256_loadu_ps(cw + 8 * g);
+		q[g] = _mm256_loadu_ps(sw + 8 * g);
+		a[g] = _mm256_loadu_ps(amp + 8 * g);
+	}
+	for(size_t n = 0; n < frames; n++)
+	{
+		__m256 sum = _mm256_setzero_ps();
+#pragma GCC unroll 4
+		for(int g = 0; g < G; g++)
+		{
+			if(out) _mm256_storeu_ps(out + n * stride + 8 * g, _mm256_mul_ps(a[g], si[g]));
+			else sum = _mm256_fmadd_ps(a[g], si[g], sum);
+			const __m256 cn = _mm256_fmsub_ps(ci[g], r[g], _mm256_mul_ps(si[g], q[g]));
+			si[g] = _mm256_fmadd_ps(si[g], r[g], _mm256_mul_ps(ci[g], q[g]));
+			ci[g] = cn;
+		}
+		if(!out) _mm256_storeu_ps(acc + n * 8, _mm256_add_ps(_mm256_loadu_ps(acc + n * 8), sum));
+	}
+#pragma GCC unroll 4
+	for(int g = 0; g < G; g++)
+	{
+		const __m256 r2 = _mm256_fmadd_ps(ci[g], ci[g], _mm256_mul_ps(si[g], si[g]));
+		const __m256 k = _mm256_fnmadd_ps(_mm256_set1_ps(0.5F), r2, _mm256_set1_ps(1.5F));
+		_mm256_storeu_ps(c + 8 * g, _mm256_mul_ps(ci[g], k));
+		_mm256_storeu_ps(s + 8 * g, _mm256_mul_ps(si[g], k));
+	}
+}
+
+__attribute__((target("avx2,fma")))
+inline void oscKernelAvx2(float *c, float *s, const float *cw, const float *sw, const float *amp, size_t num,
+		float *out, size_t stride, float *acc, size_t frames)
+{
+	size_t i = 0;
+	for(; i + 32 <= num; i += 32) oscGroupsAvx2<4>(c + i, s + i, cw + i, sw + i, amp + i, out ? out + i : out, stride, acc, frames);
+	for(; i < num; i += 8) oscGroupsAvx2<1>(c + i, s + i, cw + i, sw + i, amp + i, out ? out + i : out, stride, acc, frames);
+}
+
+template <int G>
+__attribute__((target("avx512f")))
+inline void oscGroupsAvx512(float *c, float *s, const float *cw, const float *sw, const float *amp,
+		float *out, size_t stride, float *acc, size_t frames)
+{
+	__m512 ci[G], si[G], r[G], q[G], a[G];
+#pragma GCC unroll 4
+	for(int g = 0; g < G; g++)
+	{
+		ci[g] = _mm512_loadu_ps(c + 16 * g);
+		si[g] = _mm512_loadu_ps(s + 16 * g);
+		r[g] = _mm512_loadu_ps(cw + 16 * g);
+		q[g] = _mm512_loadu_ps(sw + 16 * g);
+		a[g] = _mm512_loadu_ps(amp + 16 * g);
+	}
+	for(size_t n = 0; n < frames; n++)
+	{
+		__m512 sum = _mm512_setzero_ps();
+#pragma GCC unroll 4
+		for(int g = 0; g < G; g++)
+		{
+			if(out) _mm512_storeu_ps(out + n * stride + 16 * g, _mm512_mul_ps(a[g], si[g]));
+			else sum = _mm512_fmadd_ps(a[g], si[g], sum);
+			const __m512 cn = _mm512_fmsub_ps(ci[g], r[g], _mm512_mul_ps(si[g], q[g]));
+			si[g] = _mm512_fmadd_ps(si[g], r[g], _mm512_mul_ps(ci[g], q[g]));
+			ci[g] = cn;
+		}
+		if(!out) _mm512_storeu_ps(acc + n * 16, _mm512_add_ps(_mm512_loadu_ps(acc + n * 16), sum));
+	}
+#pragma GCC unroll 4
+	for(int g = 0; g < G; g++)
+	{
+		const __m512 r2 = _mm512_fmadd_ps(ci[g], ci[g], _mm512_mul_ps(si[g], si[g]));
+		const __m512 k = _mm512_fnmadd_ps(_mm512_set1_ps(0.5F), r2, _mm512_set1_ps(1.5F));
+		_mm512_storeu_ps(c + 16 * g, _mm512_mul_ps(ci[g], k));
+		_mm512_storeu_ps(s + 16 * g, _mm512_mul_ps(si[g], k));
+	}
+}
+
+__attribute__((target("avx512f")))
+inline void oscKernelAvx512(float *c, float *s, const float *cw, const float *sw, const float *amp, size_t num,
+		float *out, size_t stride, float *acc, size_t frames)
+{
+	size_t i = 0;
+	for(; i + 64 <= num; i += 64) oscGroupsAvx512<4>(c + i, s + i, cw + i, sw + i, amp + i, out ? out + i : out, stride, acc, frames);
+	for(; i < num; i += 16) oscGroupsAvx512<1>(c + i, s + i, cw + i, sw + i, amp + i, out ? out + i : out, stride, acc, frames);
+}
+#endif /* DSP_FIR_SIMD_X86 */
+
+/* Exported class -------------------------------------------------------------*/
+class OscillatorBank
+{
+public:
+	OscillatorBank() { setIsa(firDetectIsa()); }
+	explicit OscillatorBank(size_t numOscillators) : OscillatorBank() { resize(numOscillators); }
+
+	// New oscillators are silent (amplitude 0) at w = 0, phase 0
+	void resize(size_t numOscillators)
+	{
+		N_ = numOscillators;
+		const size_t P = (N_ + DSP_OSC_ALIGN - 1) / DSP_OSC_ALIGN * DSP_OSC_ALIGN;
+		c_.resize(P, 1.0F);
+		s_.resize(P, 0.0F);
+		cw_.resize(P, 1.0F);
+		sw_.resize(P, 0.0F);
+		amp_.resize(P, 0.0F);
+		// Padding lanes stay silent
+		for(size_t i = N_; i < P; i++) amp_[i] = 0.0F;
+	}
+
+	// Force a kernel width, e.g. to benchmark or to compare against scalar
+	void setIsa(FirIsa isa)
+	{
+		isa_ = isa;
+		width_ = 1;
+		kernel_ = oscKernelScalar;
+#ifdef DSP_FIR_SIMD_X86
+		switch(isa)
+		{
+		case FIR_ISA_AVX512: width_ = 16; kernel_ = oscKernelAvx512; break;
+		case FIR_ISA_AVX2: width_ = 8; kernel_ = oscKernelAvx2; break;
+		case FIR_ISA_SSE2: width_ = 4; kernel_ = oscKernelSse2; break;
+		default: break;
+		}
+#endif
+	}
+
+	// w in rad/sample (2*pi*F/Fs); takes effect on the next sample, phase continuous
+	void setFrequency(size_t i, float w)
+	{
+		cw_[i] = (float)cos((double)w);
+		sw_[i] = (float)sin((double)w);
+	}
+
+	void setAmplitude(size_t i, float amp) { amp_[i] = amp; }
+
+	// Output amp * sin(phase + w n) from now on
+	void setPhase(size_t i, float phase)
+	{
+		c_[i] = (float)cos((double)phase);
+		s_[i] = (float)sin((double)phase);
+	}
+
+	void set(size_t i, float w, float amp, float phase = 0.0F)
+	{
+		setFrequency(i, w);
+		setAmplitude(i, amp);
+		setPhase(i, phase);
+	}
+
+	size_t size() const { return N_; }
+	FirIsa isa() const { return isa_; }
+
+	// y[n] = sum of all oscillators, frames samples
+	void mix(float *y, size_t frames)
+	{
+		const size_t P = padded();
+		float acc[DSP_OSC_TILE * DSP_OSC_ALIGN];
+		for(size_t n0 = 0; n0 < frames; n0 += DSP_OSC_TILE)
+		{
+			const size_t m = frames - n0 < DSP_OSC_TILE ? frames - n0 : DSP_OSC_TILE;
+			memset(acc, 0, m * width_ * sizeof(float));
+			kernel_(c_.data(), s_.data(), cw_.data(), sw_.data(), amp_.data(), P, nullptr, 0, acc, m);
+			for(size_t n = 0; n < m; n++)
+			{
+				float v = 0.0F;
+				for(size_t l = 0; l < width_; l++) v += acc[n * width_ + l];
+				y[n0 + n] = v;
+			}
+		}
+	}
+
+	// y holds frames x stride floats, oscillator i goes to y[n*stride + i]
+	// (one tone per channel of an interleaved buffer); stride >= size()
+	// rounded up to DSP_OSC_ALIGN, the padding columns are written with 0.
+	void render(float *y, size_t stride, size_t frames)
+	{
+		const size_t P = padded();
+		for(size_t n0 = 0; n0 < frames; n0 += DSP_OSC_TILE)
+		{
+			const size_t m = frames - n0 < DSP_OSC_TILE ? frames - n0 : DSP_OSC_TILE;
+			kernel_(c_.data(), s_.data(), cw_.data(), sw_.data(), amp_.data(), P, y + n0 * stride, stride, nullptr, m);
+		}
+	}
+
+	// Smallest stride render() accepts
+	size_t padded() const { return (N_ + DSP_OSC_ALIGN - 1) / DSP_OSC_ALIGN * DSP_OSC_ALIGN; }
+
+private:
+	std::vector<float> c_, s_;		// cos/sin of the current phase
+	std::vector<float> cw_, sw_;	// cos/sin of the phase step
+	std::vector<float> amp_;
+	size_t N_ = 0;
+	size_t width_ = 1;
+	FirIsa isa_ = FIR_ISA_SCALAR;
+	OscKernel kernel_ = oscKernelScalar;
+};
+
+} // namespace dsp
+
+#endif /* DSP_OSCILLATOR_H_ */
@@ -0,0 +1,85 @@
+/*
+ * param_slot.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Lock-free hand-over of a parameter set (cutoff, gain, biquad sections,
+ *  ...) from one control task to the audio loop. Neither side ever waits, so
+ *  a key press cannot stall an audio block:
+ *  - the writer fills edit() at leisure and publish()es it,
+ *  - the reader calls fetch() once per block and uses current() until the
+ *    next fetch; a burst of publishes between two blocks just delivers the
+ *    latest set.
+ *  This is a double buffer (the reader's front copy and the writer's back
+ *  copy) plus a spare that sits in the middle: the swap is one atomic
+ *  exchange of the middle index on each side, so the writer never has to wait
+ *  for the reader to let go of the front copy (a plain double buffer needs
+ *  a lock or a retry there). T is copied by the writer only; it should be
+ *  plain data (fixed arrays, no heap) so the reader never allocates.
+ *
+ *  One writer and one reader. std::atomic on a 32-bit word is lock-free on
+ *  the ESP32 (S32C1I) and the Cortex-M4 (LDREX/STREX).
+ */
+
+#ifndef DSP_PARAM_SLOT_H_
+#define DSP_PARAM_SLOT_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <atomic>
+
+namespace dsp {
+
+/* Exported class -------------------------------------------------------------*/
+template <typename T>
+class ParamSlot
+{
+public:
+	ParamSlot() : middle_(2) {}
+	explicit ParamSlot(const T &init) : ParamSlot()
+	{
+		buf_[0] = buf_[1] = buf_[2] = init;
+	}
+
+	// Writer: the copy to fill. Only valid until publish().
+	T &edit() { return buf_[back_]; }
+
+	// Writer: hands edit() to the reader, release orders the writes before it
+	void publish()
+	{
+		last_ = back_;
+		back_ = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// Writer: edit() starts from the last published set (handy for one-field
+	// changes). The published copy is never handed back to the writer before
+	// a newer one is published, so reading it here is safe.
+	void editFromLast()
+	{
+		buf_[back_] = buf_[last_];
+	}
+
+	// Reader: true if a new set was published since the last fetch
+	bool fetch()
+	{
+		if(!(middle_.load(std::memory_order_relaxed) & FRESH)) return false;
+		front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+
+	// Reader: the set in use, stable until the next fetch()
+	const T &current() const { return buf_[front_]; }
+
+private:
+	enum { INDEX = 3, FRESH = 4 };
+
+	T buf_[3];
+	std::atomic<unsigned> middle_;	// Spare index, FRESH if it holds an unread set
+	unsigned back_ = 0;				// Writer side
+	unsigned last_ = 0;				// Writer side
+	unsigned front_ = 1;			// Reader side
+};
+
+} // namespace dsp
+
+#endif /* DSP_PARAM_SLOT_H_ */
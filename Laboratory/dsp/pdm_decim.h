@@ -0,0 +1,399 @@
+/*
+ * pdm_decim.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  PDM microphone bitstream to PCM, the open replacement of ST's PDM_Filter
+ *  in lab5. Plain C and static inline like fir_q15.h, so the same decimator
+ *  runs on the Cortex-M4 and in bench/bench_pdm_decim.cpp. Chain, for
+ *  decimation D (PDM bits per PCM sample, 1.536 MHz / 32 = 48 kHz in lab5):
+ *  - CIC of order N decimating by R = D/4, run as its FIR equivalent
+ *    (boxcar^N, N(R-1)+1 taps) on several bits at a time: a table per group
+ *    of bits of the kernel holds the partial sum of its taps for every bit
+ *    pattern, so one CIC output is a few lookups instead of N integrators
+ *    per bit and N combs per output. The front end sets the group width,
+ *    for B = ceil((N(R-1)+1)/8) kernel bytes:
+ *      PDM_DEC_FE_LUT4      2B lookups, 2B x 16 words (640 B at D=32, N=5)
+ *      PDM_DEC_FE_LUT8      B lookups, B x 256 words (5 KB)
+ *      PDM_DEC_FE_LUT16     ceil(B/2) lookups, ceil(B/2) x 65536 words
+ *                           (768 KB: host or large parts only)
+ *    There is no table-free popcount front end: the bit count of a byte is
+ *    a single boxcar of 8 bits, one zero at each multiple of the byte rate
+ *    where the CIC needs N, and at D = 32 the byte rate is already the CIC
+ *    output rate, so the other N-1 stages have nothing left to decimate.
+ *    That leaves about 19 dB of alias rejection instead of 70-80.
+ *    The table is caller memory of PDM_DEC_TABLE_WORDS() words, built by
+ *    PDM_DEC_Init() (RAM; the smaller tables can be copied to a const array
+ *    in flash once the configuration is fixed),
+ *  - two half-band FIRs decimating by 2 each (Kaiser windowed, every second
+ *    tap is zero and the taps are symmetric: (L+1)/4 multiplies per output),
+ *  - a compensation FIR at the output rate, least-squares fit at init to the
+ *    inverse of the CIC droop and the half-band edge over the passband
+ *    (PDM_DEC_PASSBAND of the output rate), with the gain folded in,
+ *  - rounding and saturation to int16.
+ *  PDM words are 16 bits as the I2S DMA stores them, bit 15 first in time.
+ *  0 dB of gain maps an all-ones bitstream to full scale.
+ *
+ *  PDM_MOD_Process() is the matching test stimulus: a 2nd order
+ *  sigma-delta modulator (noise shaped by (1 - z^-1)^2, stable for inputs
+ *  up to about 0.7) packing its bits the same way.
+ */
+
+#ifndef DSP_PDM_DECIM_H_
+#define DSP_PDM_DECIM_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI	(3.14159265358979323846)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported define ------------------------------------------------------------*/
+#define PDM_DEC_MAX_ORDER		(5)
+#define PDM_DEC_MAX_R			(16)	// D = 64
+#define PDM_DEC_MAX_BYTES		((PDM_DEC_MAX_ORDER * (PDM_DEC_MAX_R - 1) + 1 + 7) / 8)
+#define PDM_DEC_HB1_TAPS		(19)	// 4k+3 so that the end taps are not zero
+#define PDM_DEC_HB2_TAPS		(67)
+#define PDM_DEC_COMP_TAPS		(15)
+#define PDM_DEC_HB_BETA			(8.0)	// Kaiser beta, about 80 dB
+#define PDM_DEC_PASSBAND		(0.42)	// Passband edge / output rate (20.2 kHz at 48 kHz)
+#define PDM_DEC_CHUNK			(16)	// Output samples per inner block
+
+// Front ends (PdmDecConfig_t.frontEnd)
+#define PDM_DEC_FE_LUT8			(0)
+#define PDM_DEC_FE_LUT4			(1)
+#define PDM_DEC_FE_LUT16		(2)
+
+// Kernel bytes B, and table words for a front end, decimation D and CIC order N
+#define PDM_DEC_KERNEL_BYTES(D, N)		(((N) * ((D) / 4 - 1) + 1 + 7) / 8)
+#define PDM_DEC_TABLE_WORDS(fe, D, N)	((fe) == PDM_DEC_FE_LUT8 ? PDM_DEC_KERNEL_BYTES(D, N) * 256 : \
+										(fe) == PDM_DEC_FE_LUT4 ? PDM_DEC_KERNEL_BYTES(D, N) * 32 : \
+										(fe) == PDM_DEC_FE_LUT16 ? (PDM_DEC_KERNEL_BYTES(D, N) + 1) / 2 * 65536 : 0)
+
+/* Exported typedef -----------------------------------------------------------*/
+typedef struct
+{
+	uint16_t decimation;	// PDM bits per PCM sample: 32 or 64
+	uint8_t cicOrder;		// 1 .. PDM_DEC_MAX_ORDER
+	float gainDb;
+	uint8_t frontEnd;		// PDM_DEC_FE_*
+} PdmDecConfig_t;
+
+typedef struct
+{
+	PdmDecConfig_t cfg;
+	uint8_t cicBytes;		// Kernel length in bytes
+	uint8_t bytesPerCic;	// R / 8
+	uint8_t lookups;		// Table lookups per CIC output
+	uint8_t histBytes;		// PDM bytes kept from the last block
+	float cicScale;			// 1 / R^N
+	int32_t *lut;			// [lookup][bit pattern] partial sums, caller memory
+	float kernel[(PDM_DEC_MAX_BYTES + 1) * 8];	// CIC kernel, DC gain 1
+	float hb1[PDM_DEC_HB1_TAPS];
+	float hb2[PDM_DEC_HB2_TAPS];
+	float comp[PDM_DEC_COMP_TAPS];			// Gain and int16 scale included
+	// Linear histories: the last taps-1 inputs, then the new block
+	uint8_t bytes[PDM_DEC_MAX_BYTES + PDM_DEC_CHUNK * 4 * PDM_DEC_MAX_R / 8];
+	float x1[PDM_DEC_HB1_TAPS - 1 + PDM_DEC_CHUNK * 4];
+	float x2[PDM_DEC_HB2_TAPS - 1 + PDM_DEC_CHUNK * 2];
+	float x3[PDM_DEC_COMP_TAPS - 1 + PDM_DEC_CHUNK];
+} PdmDecimator_t;
+
+typedef struct
+{
+	float i1, i2;	// Integrators
+	float y;		// Last output bit, +1 or -1
+} PdmModulator_t;
+
+/* Exported function prototypes -----------------------------------------------*/
+static inline double PDM_DEC_BesselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	for(int k = 1; k < 40; k++)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+// Kaiser windowed half-band, odd taps scaled so that the DC gain is exactly 1
+static inline void PDM_DEC_HalfBand(float *h, int L)
+{
+	const int c = (L - 1) / 2;
+	double odd = 0.0;
+	for(int n = 0; n < L; n++)
+	{
+		const int j = n - c;
+		const double t = (double)j / (double)c;
+		const double w = PDM_DEC_BesselI0(PDM_DEC_HB_BETA * sqrt(1.0 - t * t)) / PDM_DEC_BesselI0(PDM_DEC_HB_BETA);
+		h[n] = (j & 1) ? (float)(sin(M_PI * j / 2.0) / (M_PI * j) * w) : 0.0F;
+		odd += h[n];
+	}
+	for(int n = 0; n < L; n++) h[n] = (float)(h[n] * 0.5 / odd);
+	h[c] = 0.5F;
+}
+
+// |H(f)| of a symmetric FIR, f in cycles per sample
+static inline double PDM_DEC_Magnitude(const float *h, int L, double f)
+{
+	double a = 0.0;
+	const int c = (L - 1) / 2;
+	for(int n = 0; n < L; n++) a += h[n] * cos(2.0 * M_PI * f * (double)(n - c));
+	return fabs(a);
+}
+
+// |H(f)| of the CIC (order N, decimation R) at f cycles per input bit
+static inline double PDM_DEC_CicMagnitude(int N, int R, double f)
+{
+	if(f == 0.0) return 1.0;
+	return pow(fabs(sin(M_PI * f * R) / (R * sin(M_PI * f))), N);
+}
+
+// |H(f)| of the CIC front end from its kernel
+static inline double PDM_DEC_FrontMagnitude(const PdmDecimator_t *pDec, double f)
+{
+	double re = 0.0, im = 0.0;
+	for(int k = 0; k < 8 * pDec->cicBytes; k++)
+	{
+		re += pDec->kernel[k] * cos(2.0 * M_PI * f * k);
+		im -= pDec->kernel[k] * sin(2.0 * M_PI * f * k);
+	}
+	return sqrt(re * re + im * im);
+}
+
+// Least-squares fit of the compensation FIR over the passband, gain included
+static inline void PDM_DEC_DesignComp(PdmDecimator_t *pDec)
+{
+	enum { P = PDM_DEC_COMP_TAPS / 2, GRID = 96 };
+	double M[P + 1][P + 2];
+	memset(M, 0, sizeof(M));
+	for(int g = 0; g <= GRID; g++)
+	{
+		// f in cycles per output sample; the half-bands run at 4x and 2x that
+		const double f = PDM_DEC_PASSBAND * g / GRID;
+		const double droop = PDM_DEC_FrontMagnitude(pDec, f / pDec->cfg.decimation) * PDM_DEC_Magnitude(pDec->hb1, PDM_DEC_HB1_TAPS, f / 4.0)
+				* PDM_DEC_Magnitude(pDec->hb2, PDM_DEC_HB2_TAPS, f / 2.0);
+		double basis[P + 1];
+		for(int k = 0; k <= P; k++) basis[k] = cos(2.0 * M_PI * f * k);
+		for(int j = 0; j <= P; j++)
+		{
+			for(int k = 0; k <= P; k++) M[j][k] += basis[j] * basis[k];
+			M[j][P + 1] += basis[j] / droop;
+		}
+	}
+	// A touch of ridge so that the fit stays smooth outside the passband
+	for(int j = 0; j <= P; j++) M[j][j] += 1e-6 * GRID;
+	// Gauss-Jordan with partial pivoting on the (P+1) x (P+2) system
+	for(int j = 0; j <= P; j++)
+	{
+		int piv = j;
+		for(int r = j + 1; r <= P; r++) if(fabs(M[r][j]) > fabs(M[piv][j])) piv = r;
+		for(int k = 0; k <= P + 1; k++) { double t = M[j][k]; M[j][k] = M[piv][k]; M[piv][k] = t; }
+		for(int r = 0; r <= P; r++)
+		{
+			if(r == j) continue;
+			const double m = M[r][j] / M[j][j];
+			for(int k = j; k <= P + 1; k++) M[r][k] -= m * M[j][k];
+		}
+	}
+	const double gain = pow(10.0, pDec->cfg.gainDb / 20.0) * 32768.0;
+	for(int k = 0; k <= P; k++)
+	{
+		const double a = M[k][P + 1] / M[k][k] * gain;
+		pDec->comp[P + k] = pDec->comp[P - k] = (float)(k ? a / 2.0 : a);
+	}
+}
+
+static inline void PDM_DEC_Reset(PdmDecimator_t *pDec)
+{
+	memset(pDec->bytes, 0x55, sizeof(pDec->bytes));	// Alternating bits: PDM silence
+	memset(pDec->x1, 0, sizeof(pDec->x1));
+	memset(pDec->x2, 0, sizeof(pDec->x2));
+	memset(pDec->x3, 0, sizeof(pDec->x3));
+}
+
+/*
+ * Builds the front end table in pTable (PDM_DEC_TABLE_WORDS() words) and
+ * designs the FIRs (double math, call once at startup). Returns 0, or -1
+ * for an unsupported configuration.
+ */
+static inline int PDM_DEC_Init(PdmDecimator_t *pDec, const PdmDecConfig_t *pCfg, int32_t *pTable)
+{
+	if((pCfg->decimation != 32 && pCfg->decimation != 64) || pCfg->cicOrder < 1 || pCfg->cicOrder > PDM_DEC_MAX_ORDER) return -1;
+	if(pCfg->frontEnd > PDM_DEC_FE_LUT16 || !pTable) return -1;
+	pDec->cfg = *pCfg;
+	pDec->lut = pTable;
+	const int R = pCfg->decimation / 4, N = pCfg->cicOrder, L = N * (R - 1) + 1;
+	const int B = (L + 7) / 8;
+	pDec->bytesPerCic = (uint8_t)(R / 8);
+	pDec->cicBytes = (uint8_t)B;
+
+	// boxcar(R)^N by repeated convolution, h[0] applies to the newest bit;
+	// zero up to a whole 16-bit lookup
+	int32_t h[(PDM_DEC_MAX_BYTES + 1) * 8] = {0}, t[(PDM_DEC_MAX_BYTES + 1) * 8];
+	int len = 1;
+	h[0] = 1;
+	for(int s = 0; s < N; s++)
+	{
+		memset(t, 0, sizeof(t));
+		for(int n = 0; n < len; n++) for(int k = 0; k < R; k++) t[n + k] += h[n];
+		len += R - 1;
+		memcpy(h, t, sizeof(h));
+	}
+	const double sum = pow((double)R, (double)N);
+	pDec->cicScale = (float)(1.0 / sum);
+	for(int k = 0; k < 8 * B; k++) pDec->kernel[k] = (float)(h[k] / sum);
+
+	// Lookup j covers taps W*j .. W*j+W-1, bit i of its index is tap W*j+i
+	// (bytes newest first, LSB first within a byte)
+	const int W = pCfg->frontEnd == PDM_DEC_FE_LUT4 ? 4 : (pCfg->frontEnd == PDM_DEC_FE_LUT16 ? 16 : 8);
+	pDec->lookups = (uint8_t)((8 * B + W - 1) / W);
+	pDec->histBytes = (uint8_t)((pDec->lookups * W + 7) / 8 - 1);
+	for(int j = 0; j < pDec->lookups; j++)
+	{
+		for(int32_t v = 0; v < (1 << W); v++)
+		{
+			int32_t acc = 0;
+			for(int i = 0; i < W; i++) acc += ((v >> i) & 1) ? h[W * j + i] : -h[W * j + i];
+			pTable[(j << W) + v] = acc;
+		}
+	}
+
+	PDM_DEC_HalfBand(pDec->hb1, PDM_DEC_HB1_TAPS);
+	PDM_DEC_HalfBand(pDec->hb2, PDM_DEC_HB2_TAPS);
+	PDM_DEC_DesignComp(pDec);
+	PDM_DEC_Reset(pDec);
+	return 0;
+}
+
+// Half-band decimation by 2: y[m] from x[2m .. 2m+L-1] (oldest first)
+static inline void PDM_DEC_HalfBandDecimate(const float *h, int L, const float *x, float *y, int numOut)
+{
+	const int c = (L - 1) / 2;
+	for(int m = 0; m < numOut; m++, x += 2)
+	{
+		float acc = 0.5F * x[c];
+		for(int j = 1; j <= c; j += 2) acc += h[c + j] * (x[c - j] + x[c + j]);
+		y[m] = acc;
+	}
+}
+
+/*
+ * numOut PCM samples from numOut*D/16 PDM words. Any numOut; the lab5 1 ms
+ * block is 48 samples from 96 words.
+ */
+static inline void PDM_DEC_Process(PdmDecimator_t *pDec, const uint16_t *pPdm, int16_t *pPcm, uint16_t numOut)
+{
+	const int B = pDec->lookups, Hb = pDec->histBytes, bpc = pDec->bytesPerCic;
+	const int32_t *lut = pDec->lut;
+	const int H1 = PDM_DEC_HB1_TAPS - 1, H2 = PDM_DEC_HB2_TAPS - 1, H3 = PDM_DEC_COMP_TAPS - 1;
+	while(numOut)
+	{
+		const int n = numOut < PDM_DEC_CHUNK ? numOut : PDM_DEC_CHUNK;
+		const int nBytes = n * 4 * bpc;
+
+		// Words to bytes in time order, after the last Hb bytes
+		uint8_t *b = &pDec->bytes[Hb];
+		for(int w = 0; w < nBytes / 2; w++, pPdm++)
+		{
+			b[2 * w] = (uint8_t)(*pPdm >> 8);
+			b[2 * w + 1] = (uint8_t)*pPdm;
+		}
+
+		// CIC: one output per bpc bytes, ending at the newest byte of the group
+		float *x1 = &pDec->x1[H1];
+		switch(pDec->cfg.frontEnd)
+		{
+		case PDM_DEC_FE_LUT4:
+			for(int c = 0; c < 4 * n; c++)
+			{
+				const uint8_t *p = &b[(c + 1) * bpc - 1];
+				int32_t acc = 0;
+				for(int q = 0; q < B / 2; q++) acc += lut[(2 * q) * 16 + (p[-q] & 15)] + lut[(2 * q + 1) * 16 + (p[-q] >> 4)];
+				x1[c] = (float)acc * pDec->cicScale;
+			}
+			break;
+		case PDM_DEC_FE_LUT16:
+			for(int c = 0; c < 4 * n; c++)
+			{
+				const uint8_t *p = &b[(c + 1) * bpc - 1];
+				int32_t acc = 0;
+				for(int q = 0; q < B; q++) acc += lut[(q << 16) + (p[-2 * q] | (p[-2 * q - 1] << 8))];
+				x1[c] = (float)acc * pDec->cicScale;
+			}
+			break;
+		default:
+			for(int c = 0; c < 4 * n; c++)
+			{
+				const uint8_t *p = &b[(c + 1) * bpc - 1];
+				int32_t acc = 0;
+				for(int q = 0; q < B; q++) acc += lut[(q << 8) + p[-q]];
+				x1[c] = (float)acc * pDec->cicScale;
+			}
+			break;
+		}
+
+		PDM_DEC_HalfBandDecimate(pDec->hb1, PDM_DEC_HB1_TAPS, pDec->x1, &pDec->x2[H2], 2 * n);
+		PDM_DEC_HalfBandDecimate(pDec->hb2, PDM_DEC_HB2_TAPS, pDec->x2, &pDec->x3[H3], n);
+
+		// Compensation FIR (symmetric), gain, round and saturate
+		for(int m = 0; m < n; m++)
+		{
+			const float *x = &pDec->x3[m];
+			float acc = pDec->comp[H3 / 2] * x[H3 / 2];
+			for(int k = 0; k < H3 / 2; k++) acc += pDec->comp[k] * (x[k] + x[H3 - k]);
+			acc += acc >= 0.0F ? 0.5F : -0.5F;
+			pPcm[m] = (int16_t)(acc > 32767.0F ? 32767 : (acc < -32768.0F ? -32768 : (int32_t)acc));
+		}
+
+		// Keep the tails for the next block
+		memmove(pDec->bytes, &pDec->bytes[nBytes], (size_t)Hb);
+		memmove(pDec->x1, &pDec->x1[4 * n], H1 * sizeof(float));
+		memmove(pDec->x2, &pDec->x2[2 * n], H2 * sizeof(float));
+		memmove(pDec->x3, &pDec->x3[n], H3 * sizeof(float));
+		pPcm += n;
+		numOut = (uint16_t)(numOut - n);
+	}
+}
+
+static inline void PDM_MOD_Init(PdmModulator_t *pMod)
+{
+	pMod->i1 = pMod->i2 = 0.0F;
+	pMod->y = 1.0F;
+}
+
+/*
+ * One bit per input sample (|x| < 0.7), packed MSB-first into 16-bit words:
+ * numBits must be a multiple of 16.
+ */
+static inline void PDM_MOD_Process(PdmModulator_t *pMod, const float *pIn, uint16_t *pPdm, size_t numBits)
+{
+	for(size_t w = 0; w < numBits / 16; w++)
+	{
+		uint16_t word = 0;
+		for(int k = 0; k < 16; k++)
+		{
+			pMod->i1 += 0.5F * (pIn[16 * w + k] - pMod->y);
+			pMod->i2 += 0.5F * (pMod->i1 - pMod->y);
+			pMod->y = pMod->i2 >= 0.0F ? 1.0F : -1.0F;
+			word = (uint16_t)((word << 1) | (pMod->y > 0.0F));
+		}
+		pPdm[w] = word;
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_PDM_DECIM_H_ */
@@ -0,0 +1,234 @@
+/*
+ * resample.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Polyphase multirate FIR: decimation by M, interpolation by L and a
+ *  rational L/M resampler (e.g. 8 kHz <-> 48 kHz is L or M = 6). Only the
+ *  outputs that are kept are computed, and no zero-stuffed input is ever
+ *  multiplied, so each output costs about numTaps/L MACs (numTaps for the
+ *  decimator) instead of numTaps at the high rate.
+ */
+
+#ifndef DSP_RESAMPLE_H_
+#define DSP_RESAMPLE_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stddef.h>
+#include <vector>
+#include "fir_design.h"
+
+namespace dsp {
+
+/* Exported function prototypes -----------------------------------------------*/
+/*
+ * Anti-aliasing/anti-imaging low-pass for a factor L/M resampler: cutoff at
+ * pi/max(L,M) (slightly inside it to leave a transition band), Kaiser window
+ * with 80 dB of stopband, tapsPerPhase*max(L,M)+1 taps (odd, linear phase).
+ */
+inline std::vector<float> resamplerDesign(int L, int M, int tapsPerPhase = 16)
+{
+	const int R = L > M ? L : M;
+	const int N = tapsPerPhase * R + 1;
+	std::vector<float> h(N);
+	FirDesignSpec spec = {FIR_LOWPASS, 0.9F * (float)M_PI / (float)R, 0.0F, N, FIR_WIN_KAISER, kaiserBeta(80.0F)};
+	firDesign(spec, h.data());
+	return h;
+}
+
+/* Exported class -------------------------------------------------------------*/
+/*
+ * Impulse response split in L phases, E_p[k] = L*h[k*L + p], plus a mirrored
+ * delay line of the low-rate input (same layout as FirFilter). The L gain
+ * restores the level lost by inserting L-1 zeros between input samples.
+ * No taps behaves as a single zero tap (all-zero output).
+ */
+class PolyphaseBank
+{
+public:
+	void init(const float *h, size_t numTaps, int L)
+	{
+		static const float zero = 0.0F;
+		if(numTaps == 0)
+		{
+			h = &zero;
+			numTaps = 1;
+		}
+		L_ = L;
+		K_ = (numTaps + L - 1) / L;
+		phases_.assign((size_t)L * K_, 0.0F);
+		for(size_t i = 0; i < numTaps; i++)
+		{
+			phases_[(i % L) * K_ + i / L] = (float)L * h[i];
+		}
+		reset();
+	}
+
+	void reset()
+	{
+		state_.assign(2 * K_, 0.0F);
+		pos_ = 0;
+	}
+
+	void push(float x)
+	{
+		pos_ = (pos_ == 0) ? K_ - 1 : pos_ - 1;
+		state_[pos_] = x;
+		state_[pos_ + K_] = x;
+	}
+
+	// sum_k E_p[k] * x[n-k]
+	float output(int p) const
+	{
+		const float *e = &phases_[(size_t)p * K_];
+		const float *w = &state_[pos_];
+		float y = 0.0F;
+		for(size_t k = 0; k < K_; k++) y += e[k] * w[k];
+		return y;
+	}
+
+	size_t tapsPerPhase() const { return K_; }
+
+private:
+	int L_ = 1;
+	size_t K_ = 0;					// Taps per phase
+	std::vector<float> phases_;		// L rows of K taps
+	std::vector<float> state_;		// Mirrored delay line, 2*K samples
+	size_t pos_ = 0;
+};
+
+/*
+ * Decimator by M: the input goes through a delay line and the FIR is only
+ * evaluated for every M-th input sample.
+ */
+class PolyphaseDecimator
+{
+public:
+	PolyphaseDecimator() {}
+	PolyphaseDecimator(int M, const float *h, size_t numTaps) { init(M, h, numTaps); }
+
+	void init(int M, const float *h, size_t numTaps)
+	{
+		M_ = M;
+		bank_.init(h, numTaps, 1);
+		reset();
+	}
+
+	void reset()
+	{
+		bank_.reset();
+		phase_ = 0;
+	}
+
+	// Returns the number of outputs written to y (at most len/M + 1)
+	size_t process(const float *x, size_t len, float *y)
+	{
+		size_t nout = 0;
+		for(size_t n = 0; n < len; n++)
+		{
+			bank_.push(x[n]);
+			if(phase_ == 0) y[nout++] = bank_.output(0);
+			if(++phase_ == M_) phase_ = 0;
+		}
+		return nout;
+	}
+
+private:
+	int M_ = 1;
+	int phase_ = 0;		// Inputs since the last output
+	PolyphaseBank bank_;
+};
+
+/*
+ * Interpolator by L: every input sample produces L outputs, output p uses
+ * the p-th phase of the filter, so the inserted zeros are never multiplied.
+ */
+class PolyphaseInterpolator
+{
+public:
+	PolyphaseInterpolator() {}
+	PolyphaseInterpolator(int L, const float *h, size_t numTaps) { init(L, h, numTaps); }
+
+	void init(int L, const float *h, size_t numTaps)
+	{
+		L_ = L;
+		bank_.init(h, numTaps, L);
+	}
+
+	void reset() { bank_.reset(); }
+
+	// Returns the number of outputs written to y (always len*L)
+	size_t process(const float *x, size_t len, float *y)
+	{
+		for(size_t n = 0; n < len; n++)
+		{
+			bank_.push(x[n]);
+			for(int p = 0; p < L_; p++) *y++ = bank_.output(p);
+		}
+		return len * (size_t)L_;
+	}
+
+private:
+	int L_ = 1;
+	PolyphaseBank bank_;
+};
+
+/*
+ * Rational resampler by L/M on the interpolator's phase bank. The output
+ * m sits at index t = m*M of the (virtual) L-times upsampled signal, i.e.
+ * input n = t/L and phase t%L, so only the outputs kept by the decimation
+ * are computed.
+ */
+class RationalResampler
+{
+public:
+	RationalResampler() {}
+	RationalResampler(int L, int M, const float *h, size_t numTaps) { init(L, M, h, numTaps); }
+
+	// Uses resamplerDesign(L, M) for the filter
+	RationalResampler(int L, int M)
+	{
+		std::vector<float> h = resamplerDesign(L, M);
+		init(L, M, h.data(), h.size());
+	}
+
+	void init(int L, int M, const float *h, size_t numTaps)
+	{
+		L_ = L;
+		M_ = M;
+		bank_.init(h, numTaps, L);
+		reset();
+	}
+
+	void reset()
+	{
+		bank_.reset();
+		t_ = 0;
+	}
+
+	// Upper bound of the outputs produced by len inputs
+	size_t maxOutputs(size_t len) const { return (len * (size_t)L_) / (size_t)M_ + 1; }
+
+	// Returns the number of outputs written to y
+	size_t process(const float *x, size_t len, float *y)
+	{
+		size_t nout = 0;
+		for(size_t n = 0; n < len; n++)
+		{
+			bank_.push(x[n]);
+			for(; t_ < L_; t_ += M_) y[nout++] = bank_.output(t_);
+			t_ -= L_;
+		}
+		return nout;
+	}
+
+private:
+	int L_ = 1, M_ = 1;
+	int t_ = 0;			// Upsampled index of the next output relative to the newest input
+	PolyphaseBank bank_;
+};
+
+} // namespace dsp
+
+#endif /* DSP_RESAMPLE_H_ */
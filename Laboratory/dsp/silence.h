@@ -0,0 +1,130 @@
+/*
+ * silence.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Silence and denormal fast path, plain C so lab5 can use it too.
+ *  - DSP_EnableFlushToZero(): subnormal floats are slow on x86 (a few
+ *    hundred cycles per operation through microcode) and decaying IIR tails
+ *    go through them on every quiet input. FTZ/DAZ treats them as zero. The
+ *    mode is per thread: call it at the start of the thread (task) that runs
+ *    the DSP.
+ *  - DSP_IsSilentF32()/DSP_IsSilentQ15(): one pass over the block, so the
+ *    filters can tell when a zero input meets a zero state; then the output
+ *    is zero and the whole block is skipped (SosCascade, MultiChannelSos,
+ *    MultiChannelFir, BIQUAD_Q31 count those blocks in SilenceStats_t).
+ *  - DSP_STATE_FLUSH: after a silent block, IIR state below it is set to
+ *    exact zero. That ends the tail (about -240 dBFS, far below any output
+ *    format) so the skip can start, and it keeps the state out of the
+ *    subnormal range where FTZ is not available.
+ */
+
+#ifndef DSP_SILENCE_H_
+#define DSP_SILENCE_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <xmmintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported define ------------------------------------------------------------*/
+#define DSP_STATE_FLUSH		(1e-12F)	// Float state magnitude flushed to 0 after silence
+
+/* Exported typedef -----------------------------------------------------------*/
+typedef struct
+{
+	uint32_t blocks;		// Blocks processed
+	uint32_t fastBlocks;	// Skipped: silent input into an all-zero state
+	uint32_t flushes;		// Times a decayed state was flushed to zero
+} SilenceStats_t;
+
+/* Exported function prototypes -----------------------------------------------*/
+/*
+ * Flush-to-zero (and denormals-are-zero where there is such a mode) for the
+ * calling thread. Returns 1 if the FPU has the mode, 0 otherwise (the state
+ * flush then still keeps the filters out of the subnormal range).
+ */
+static inline int DSP_EnableFlushToZero(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	_mm_setcsr(_mm_getcsr() | 0x8040);	// FTZ (bit 15) | DAZ (bit 6)
+	return 1;
+#elif defined(__aarch64__)
+	uint64_t fpcr;
+	__asm__ volatile("mrs %0, fpcr" : "=r"(fpcr));
+	__asm__ volatile("msr fpcr, %0" : : "r"(fpcr | (1ULL << 24)));	// FZ
+	return 1;
+#elif defined(__ARM_FP)
+	uint32_t fpscr;
+	__asm__ volatile("vmrs %0, fpscr" : "=r"(fpscr));
+	__asm__ volatile("vmsr fpscr, %0" : : "r"(fpscr | (1UL << 24)));	// FZ (Cortex-M4 FPv4-SP)
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+// 1 if every |x[n]| <= threshold; threshold 0 tests for exact zeros (+0/-0)
+static inline int DSP_IsSilentF32(const float *x, size_t len, float threshold)
+{
+	if(threshold > 0.0F)
+	{
+		for(size_t n = 0; n < len; n++)
+		{
+			if(x[n] > threshold || x[n] < -threshold) return 0;
+		}
+		return 1;
+	}
+	// Bit test without early exit, so the loop vectorizes
+	uint32_t acc = 0;
+	for(size_t n = 0; n < len; n++)
+	{
+		uint32_t u;
+		memcpy(&u, &x[n], sizeof(u));
+		acc |= u << 1;	// Drop the sign bit
+	}
+	return acc == 0;
+}
+
+// Same for int16 samples stride apart (one channel of an interleaved buffer)
+static inline int DSP_IsSilentQ15(const int16_t *x, size_t len, size_t stride, int16_t threshold)
+{
+	int32_t peak = 0;
+	for(size_t n = 0; n < len; n++)
+	{
+		int32_t v = x[n * stride] < 0 ? -(int32_t)x[n * stride] : x[n * stride];
+		peak = v > peak ? v : peak;
+	}
+	return peak <= threshold;
+}
+
+// Sets every |z[k]| < threshold to 0, returns 1 if all of z is 0 then.
+// Per element: the sections of a cascade decay at different rates, the fast
+// ones would reach the subnormal range long before the slow ones are quiet.
+// Exact zeros count with any threshold, so 0 (never flush) still lets a
+// state that decayed to zero by itself take the silent-block fast path.
+static inline int DSP_FlushF32(float *z, size_t len, float threshold)
+{
+	int zero = 1;
+	for(size_t k = 0; k < len; k++)
+	{
+		if(z[k] == 0.0F) continue;
+		if(z[k] < threshold && z[k] > -threshold) z[k] = 0.0F;
+		else zero = 0;
+	}
+	return zero;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_SILENCE_H_ */
@@ -0,0 +1,226 @@
+/*
+ * spsc_ring.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Single-producer/single-consumer ring buffer of int16 samples, the
+ *  replacement of lab5's Fifo_t. Plain C, static inline.
+ *  - head counts the samples ever written and is stored by the producer
+ *    only; tail counts the samples ever read and is stored by the consumer
+ *    only. Neither side read-modify-writes a shared word, so one side can be
+ *    an ISR and the other the main loop without disabling interrupts.
+ *  - The counters run freely over 32 bits: head - tail is the fill level
+ *    even across the wrap, and all capacity samples are usable (no empty
+ *    slot to tell full from empty).
+ *  - capacity is a power of two, the buffer index is counter & mask.
+ *  - The producer loads tail with acquire and publishes head with release
+ *    after the samples are in the buffer (and vice versa), so the data is
+ *    visible before the index. On the single-core Cortex-M4 this costs a DMB
+ *    at most; the GCC __atomic builtins keep the compiler from moving the
+ *    buffer accesses across the index update, which volatile does not.
+ *  - Zero copy: SPSC_Reserve()/SPSC_Commit() hand the producer the free
+ *    room and SPSC_Peek()/SPSC_Consume() hand the consumer the stored
+ *    samples as at most two spans (up to the end of the buffer, then from its
+ *    start), so a decoder can write and a DMA stage can read in place.
+ *  - SPSC_ReadStereo(): the I2S TX transfer, mono samples out of the ring
+ *    into an interleaved stereo DMA half, two samples per 32-bit load and
+ *    two 32-bit stores (PKHBT/PKHTB on the M4), eight per SSE2 unpack on x86.
+ */
+
+#ifndef DSP_SPSC_RING_H_
+#define DSP_SPSC_RING_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported typedef -----------------------------------------------------------*/
+typedef struct
+{
+	int16_t *buffer;	// capacity samples (user memory)
+	uint32_t mask;		// capacity - 1
+	uint32_t head;		// Samples written, stored by the producer only
+	uint32_t tail;		// Samples read, stored by the consumer only
+} SpscRing_t;
+
+typedef struct
+{
+	int16_t *data[2];	// data[1] is the wrapped part at the start of the buffer
+	uint32_t len[2];	// len[1] is 0 unless the span wraps
+} SpscSpan_t;
+
+/* Exported function prototypes -----------------------------------------------*/
+/*
+ * capacity must be a power of two (the indices are masked). Returns 0, or -1
+ * if it is not; call before either side runs.
+ */
+static inline int SPSC_Init(SpscRing_t *pRing, int16_t *pBuffer, uint32_t capacity)
+{
+	if(!capacity || (capacity & (capacity - 1))) return -1;
+	pRing->buffer = pBuffer;
+	pRing->mask = capacity - 1;
+	pRing->head = 0;
+	pRing->tail = 0;
+	return 0;
+}
+
+static inline uint32_t SPSC_Capacity(const SpscRing_t *pRing) { return pRing->mask + 1; }
+
+// Fill level; exact on the consumer side, a lower bound anywhere else
+static inline uint32_t SPSC_Count(const SpscRing_t *pRing)
+{
+	return __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&pRing->tail, __ATOMIC_RELAXED);
+}
+
+// Free room; exact on the producer side, a lower bound anywhere else
+static inline uint32_t SPSC_Space(const SpscRing_t *pRing)
+{
+	return pRing->mask + 1 - (__atomic_load_n(&pRing->head, __ATOMIC_RELAXED)
+			- __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE));
+}
+
+// Producer: 0, or -1 if full
+static inline int SPSC_Write(SpscRing_t *pRing, int16_t din)
+{
+	const uint32_t head = pRing->head;
+	if(head - __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE) > pRing->mask) return -1;
+	pRing->buffer[head & pRing->mask] = din;
+	__atomic_store_n(&pRing->head, head + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+// Consumer: 0, or -1 if empty
+static inline int SPSC_Read(SpscRing_t *pRing, int16_t *dout)
+{
+	const uint32_t tail = pRing->tail;
+	if(__atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE) == tail) return -1;
+	*dout = pRing->buffer[tail & pRing->mask];
+	__atomic_store_n(&pRing->tail, tail + 1, __ATOMIC_RELEASE);
+	return 0;
+}
+
+// Splits len samples starting at counter pos into the spans of the buffer
+static inline uint32_t SPSC_Spans(const SpscRing_t *pRing, uint32_t pos, uint32_t len, SpscSpan_t *pSpan)
+{
+	const uint32_t i = pos & pRing->mask;
+	const uint32_t first = (len < pRing->mask + 1 - i) ? len : pRing->mask + 1 - i;
+	pSpan->data[0] = &pRing->buffer[i];
+	pSpan->len[0] = first;
+	pSpan->data[1] = &pRing->buffer[0];
+	pSpan->len[1] = len - first;
+	return len;
+}
+
+/*
+ * Producer: up to len free samples to write in place, returns their number.
+ * Nothing is visible to the consumer before SPSC_Commit(); reserving again
+ * without a commit returns the same room.
+ */
+static inline uint32_t SPSC_Reserve(SpscRing_t *pRing, uint32_t len, SpscSpan_t *pSpan)
+{
+	const uint32_t head = pRing->head;
+	const uint32_t space = pRing->mask + 1 - (head - __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE));
+	return SPSC_Spans(pRing, head, len < space ? len : space, pSpan);
+}
+
+// Producer: publishes the first len reserved samples
+static inline void SPSC_Commit(SpscRing_t *pRing, uint32_t len)
+{
+	__atomic_store_n(&pRing->head, pRing->head + len, __ATOMIC_RELEASE);
+}
+
+// Consumer: up to len stored samples to read in place, returns their number
+static inline uint32_t SPSC_Peek(SpscRing_t *pRing, uint32_t len, SpscSpan_t *pSpan)
+{
+	const uint32_t tail = pRing->tail;
+	const uint32_t count = __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE) - tail;
+	return SPSC_Spans(pRing, tail, len < count ? len : count, pSpan);
+}
+
+// Consumer: releases the first len peeked samples to the producer
+static inline void SPSC_Consume(SpscRing_t *pRing, uint32_t len)
+{
+	__atomic_store_n(&pRing->tail, pRing->tail + len, __ATOMIC_RELEASE);
+}
+
+// Producer: copies as much of buffer as fits, returns the number written
+static inline uint32_t SPSC_WriteBlock(SpscRing_t *pRing, const int16_t *buffer, uint32_t len)
+{
+	SpscSpan_t span;
+	len = SPSC_Reserve(pRing, len, &span);
+	memcpy(span.data[0], buffer, span.len[0] * sizeof(int16_t));
+	memcpy(span.data[1], buffer + span.len[0], span.len[1] * sizeof(int16_t));
+	SPSC_Commit(pRing, len);
+	return len;
+}
+
+// Consumer: copies up to len samples out, returns the number read
+static inline uint32_t SPSC_ReadBlock(SpscRing_t *pRing, int16_t *buffer, uint32_t len)
+{
+	SpscSpan_t span;
+	len = SPSC_Peek(pRing, len, &span);
+	memcpy(buffer, span.data[0], span.len[0] * sizeof(int16_t));
+	memcpy(buffer + span.len[0], span.data[1], span.len[1] * sizeof(int16_t));
+	SPSC_Consume(pRing, len);
+	return len;
+}
+
+// pOut[2n] = pOut[2n+1] = pIn[n], word-wide (little-endian); no alignment needed (LDR/STR
+// and memcpy of 4 bytes are fine unaligned on the M4 and x86)
+static inline void SPSC_DupStereoWord(const int16_t *pIn, int16_t *pOut, uint32_t len)
+{
+	uint32_t n = 0;
+	for(; n + 2 <= len; n += 2)
+	{
+		uint32_t x, lo, hi;
+		memcpy(&x, &pIn[n], sizeof(x));
+		lo = (x & 0xFFFFU) | (x << 16);			// {x0, x0}
+		hi = (x >> 16) | (x & 0xFFFF0000U);		// {x1, x1}
+		memcpy(&pOut[2 * n], &lo, sizeof(lo));
+		memcpy(&pOut[2 * n + 2], &hi, sizeof(hi));
+	}
+	if(n < len) pOut[2 * n] = pOut[2 * n + 1] = pIn[n];
+}
+
+static inline void SPSC_DupStereo(const int16_t *pIn, int16_t *pOut, uint32_t len)
+{
+	uint32_t n = 0;
+#if defined(__SSE2__)
+	for(; n + 8 <= len; n += 8)
+	{
+		__m128i x = _mm_loadu_si128((const __m128i *)&pIn[n]);
+		_mm_storeu_si128((__m128i *)&pOut[2 * n], _mm_unpacklo_epi16(x, x));
+		_mm_storeu_si128((__m128i *)&pOut[2 * n + 8], _mm_unpackhi_epi16(x, x));
+	}
+#endif
+	SPSC_DupStereoWord(&pIn[n], &pOut[2 * n], len - n);
+}
+
+/*
+ * Consumer: up to frames samples into pOut as interleaved stereo frames (each
+ * sample in both channels), returns the number of frames written.
+ */
+static inline uint32_t SPSC_ReadStereo(SpscRing_t *pRing, int16_t *pOut, uint32_t frames)
+{
+	SpscSpan_t span;
+	frames = SPSC_Peek(pRing, frames, &span);
+	SPSC_DupStereo(span.data[0], pOut, span.len[0]);
+	SPSC_DupStereo(span.data[1], &pOut[2 * span.len[0]], span.len[1]);
+	SPSC_Consume(pRing, frames);
+	return frames;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DSP_SPSC_RING_H_ */
@@ -0,0 +1,148 @@
+/*
+ * iir_gen.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Build-time IIR generator: designs a Butterworth or Chebyshev I filter with
+ *  iir_design.h and writes a header with the biquad sections, ready for
+ *  dsp::SosCascade (float) or BIQUAD_Q31 (-q, Q2.30 as BIQUAD_Q31_Quantize()
+ *  would give). Replaces the butter() + copy into Lab10/coefs round trip.
+ *
+ *  Usage: iir_gen [options] family type order fs f1 [f2]
+ *    family           butter | cheby1
+ *    type             lp | hp | bp | bs (bp/bs take f2, order doubles)
+ *    fs, f1, f2       Sample rate and band edges in Hz
+ *  Options:
+ *    -n name          Array/define prefix (default iir)
+ *    -o file          Output file (default stdout)
+ *    -r dB            Chebyshev passband ripple (default 1)
+ *    -u               No prewarping (analog edges = 2*pi*f/fs)
+ *    -q               Also emit the Q2.30 table for BIQUAD_Q31
+ *
+ *  Example, the 20 Hz DC blocker of lab5:
+ *    iir_gen -n hpf -q -o hpf_coefs.h butter hp 2 48000 20
+ *
+ *  Build: g++ -O2 -std=c++17 iir_gen.cpp -o iir_gen
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+#include "../iir_design.h"
+#include "../iir_q31.h"
+
+/* Private function reference -----------------------------------------------*/
+static void usage()
+{
+	fprintf(stderr, "usage: iir_gen [-n name] [-o file] [-r dB] [-u] [-q] butter|cheby1 lp|hp|bp|bs order fs f1 [f2]\n");
+}
+
+static std::string upper(const std::string &s)
+{
+	std::string u(s);
+	for(char &c : u) c = (char)toupper((unsigned char)c);
+	return u;
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main(int argc, char **argv)
+{
+	std::string name = "iir";
+	const char *outPath = nullptr;
+	float ripple = 1.0F;
+	bool prewarp = true, q31 = false;
+	int i = 1;
+	for(; i < argc && argv[i][0] == '-'; i++)
+	{
+		if(!strcmp(argv[i], "-n") && i + 1 < argc) name = argv[++i];
+		else if(!strcmp(argv[i], "-o") && i + 1 < argc) outPath = argv[++i];
+		else if(!strcmp(argv[i], "-r") && i + 1 < argc) ripple = (float)atof(argv[++i]);
+		else if(!strcmp(argv[i], "-u")) prewarp = false;
+		else if(!strcmp(argv[i], "-q")) q31 = true;
+		else { usage(); return 1; }
+	}
+	if(argc - i < 5)
+	{
+		usage();
+		return 1;
+	}
+
+	dsp::IirDesignSpec spec = {dsp::IIR_LOWPASS, dsp::IIR_BUTTERWORTH, 0, 0.0F, 0.0F, ripple, prewarp};
+	const std::string family = argv[i++], type = argv[i++];
+	if(family == "cheby1") spec.family = dsp::IIR_CHEBYSHEV1;
+	else if(family != "butter") { usage(); return 1; }
+	if(type == "hp") spec.type = dsp::IIR_HIGHPASS;
+	else if(type == "bp") spec.type = dsp::IIR_BANDPASS;
+	else if(type == "bs") spec.type = dsp::IIR_BANDSTOP;
+	else if(type != "lp") { usage(); return 1; }
+	const bool band = spec.type == dsp::IIR_BANDPASS || spec.type == dsp::IIR_BANDSTOP;
+	if(argc - i != (band ? 4 : 3))
+	{
+		usage();
+		return 1;
+	}
+
+	spec.order = atoi(argv[i++]);
+	const double fs = atof(argv[i++]);
+	const double f1 = atof(argv[i++]), f2 = band ? atof(argv[i++]) : 0.0;
+	spec.w1 = (float)(2.0 * M_PI * f1 / fs);
+	spec.w2 = (float)(2.0 * M_PI * f2 / fs);
+
+	std::vector<dsp::Biquad> sos;
+	if(fs <= 0.0 || !dsp::iirDesign(spec, sos))
+	{
+		fprintf(stderr, "Invalid design (order 1..%d, 0 < f1 < f2 < fs/2)\n", IIR_MAX_ORDER);
+		return 1;
+	}
+
+	FILE *out = outPath ? fopen(outPath, "w") : stdout;
+	if(!out)
+	{
+		fprintf(stderr, "Cannot write %s\n", outPath);
+		return 1;
+	}
+	const std::string N = upper(name) + "_NUM_STAGES";
+	const size_t S = sos.size();
+
+	fprintf(out, "/*\n * Generated by iir_gen, do not edit:\n *  ");
+	for(int k = 0; k < argc; k++) fprintf(out, " %s", argv[k]);
+	fprintf(out, "\n * %s %s, order %d, %g", family.c_str(), type.c_str(), spec.order, f1);
+	if(band) fprintf(out, "..%g", f2);
+	fprintf(out, " Hz at %g Hz%s\n", fs, prewarp ? "" : ", not prewarped");
+	fprintf(out, " * Sections {b0, b1, b2, a1, a2}, a0 = 1, in processing order.\n */\n\n");
+	fprintf(out, "#ifndef %s_COEFS_H_\n#define %s_COEFS_H_\n\n", upper(name).c_str(), upper(name).c_str());
+	if(q31) fprintf(out, "#include <stdint.h>\n\n");
+	fprintf(out, "#define %s\t(%zu)\n\n", N.c_str(), S);
+
+	fprintf(out, "static const float %s_sos[%s * 5] = {\n", name.c_str(), N.c_str());
+	for(size_t s = 0; s < S; s++)
+	{
+		const dsp::Biquad &q = sos[s];
+		fprintf(out, "\t%.9g, %.9g, %.9g, %.9g, %.9g%s\n", q.b0, q.b1, q.b2, q.a1, q.a2, s + 1 < S ? "," : "");
+	}
+	fprintf(out, "};\n");
+
+	if(q31)
+	{
+		std::vector<int32_t> coefs(S * BIQUAD_Q31_COEFS);
+		const int nsat = BIQUAD_Q31_Quantize(&sos[0].b0, coefs.data(), (uint8_t)S);
+		if(nsat) fprintf(stderr, "Warning: %d coefficient(s) saturated in Q2.30\n", nsat);
+		fprintf(out, "\n/* Q2.30 for BIQUAD_Q31_Init() */\nstatic const int32_t %s_sos_q31[%s * 5] = {\n", name.c_str(), N.c_str());
+		for(size_t s = 0; s < S; s++)
+		{
+			const int32_t *c = &coefs[s * BIQUAD_Q31_COEFS];
+			fprintf(out, "\t%ld, %ld, %ld, %ld, %ld%s\n", (long)c[0], (long)c[1], (long)c[2], (long)c[3], (long)c[4],
+					s + 1 < S ? "," : "");
+		}
+		fprintf(out, "};\n");
+	}
+	fprintf(out, "\n#endif\n");
+	if(out != stdout) fclose(out);
+	return 0;
+}
@@ -0,0 +1,293 @@
+/*
+ * wav_filter.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Offline batch runner: streams a WAV file in fixed-size chunks through a
+ *  chain of the same filters used on the boards and writes the result, with
+ *  RAM bounded by the chunk size. Reports throughput in samples/second.
+ *  FIR stages from DSP_FIR_FFT_CROSSOVER taps run as FFT convolution; the
+ *  block delay it adds is taken out (the first outputs are dropped, zeros
+ *  flush the tail), so the output lines up with the input sample for sample.
+ *  Outputs past 4 GB are written as RF64.
+ *
+ *  Usage: wav_filter [-b frames] [-f] in.wav out.wav stage [stage ...]
+ *    -b frames        Chunk size in frames (default 65536)
+ *    -f               Write 32-bit float instead of 16-bit PCM
+ *  Stages (applied in order, independently on every channel):
+ *    fir:file[:name]  FIR taps from a C snippet (first array, or array name)
+ *    iir:file         IIR b_coefs/a_coefs from a C snippet (a0 = 1 omitted),
+ *                     run as a biquad cascade
+ *    butter:t:N:f1[:f2]         Butterworth, t = lp/hp/bp/bs, order N
+ *    cheby1:t:N:dB:f1[:f2]      Chebyshev I with dB passband ripple
+ *    lp:fc:taps       Hamming low-pass at fc Hz
+ *    hp:fc:taps       Hamming high-pass at fc Hz (odd taps)
+ *    bp:f1:f2:taps    Hamming band-pass
+ *    bs:f1:f2:taps    Hamming band-stop (odd taps)
+ *    gain:dB          Gain in dB
+ *
+ *  Example, the Lab10 guitar through the Lab9 low-pass:
+ *    wav_filter ../../Lab10/guitar_1.wav out.wav lp:2000:101 gain:-3
+ *  and through the Lab10 IIR:
+ *    wav_filter ../../Lab10/guitar_1.wav out.wav iir:../../Lab10/coefs
+ *  or the same cutoff designed on the fly (Lab10 is 0.25*fs/2):
+ *    wav_filter ../../Lab10/guitar_1.wav out.wav butter:lp:2:5512.5
+ *
+ *  Build: g++ -O2 -std=c++17 wav_filter.cpp -o wav_filter
+ */
+
+/* Private Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../wav.h"
+#include "../coef_file.h"
+#include "../fir_design.h"
+#include "../fir_fft.h"
+#include "../iir.h"
+#include "../iir_design.h"
+
+/* Private define ------------------------------------------------------------*/
+#define DEFAULT_CHUNK_FRAMES	(65536)
+
+/* Private typedef -----------------------------------------------------------*/
+// One processing stage with independent state per channel, planar in place
+struct Stage
+{
+	virtual ~Stage() {}
+	virtual void process(size_t ch, float *x, size_t len) = 0;
+	virtual size_t latency() const { return 0; }	// Block delay on top of the filter's own
+};
+
+struct FirStage : Stage
+{
+	std::vector<dsp::FirEngine> fir;
+
+	FirStage(const std::vector<float> &h, size_t channels) : fir(channels)
+	{
+		for(dsp::FirEngine &f : fir) f.setCoefs(h.data(), h.size(), dsp::FIR_METHOD_AUTO);
+	}
+
+	void process(size_t ch, float *x, size_t len) override { fir[ch].process(x, x, len); }
+	size_t latency() const override { return fir.empty() ? 0 : fir[0].latency(); }
+};
+
+struct IirStage : Stage
+{
+	std::vector<dsp::SosCascade> iir;
+
+	IirStage(const std::vector<dsp::Biquad> &sos, size_t channels) : iir(channels, dsp::SosCascade(sos)) {}
+
+	void process(size_t ch, float *x, size_t len) override { iir[ch].process(x, x, len); }
+};
+
+struct GainStage : Stage
+{
+	float g;
+
+	explicit GainStage(float dB) : g(powf(10.0F, dB / 20.0F)) {}
+
+	void process(size_t, float *x, size_t len) override
+	{
+		for(size_t n = 0; n < len; n++) x[n] *= g;
+	}
+};
+
+/* Private function reference -----------------------------------------------*/
+static void usage()
+{
+	fprintf(stderr, "usage: wav_filter [-b frames] [-f] in.wav out.wav stage [stage ...]\n"
+			"stages: fir:file[:name] iir:file butter:t:N:f1[:f2] cheby1:t:N:dB:f1[:f2] lp:fc:taps hp:fc:taps bp:f1:f2:taps bs:f1:f2:taps gain:dB\n");
+}
+
+static std::vector<std::string> split(const char *s)
+{
+	std::vector<std::string> parts;
+	std::string cur;
+	for(; *s; s++)
+	{
+		if(*s == ':') { parts.push_back(cur); cur.clear(); }
+		else cur += *s;
+	}
+	parts.push_back(cur);
+	return parts;
+}
+
+static std::unique_ptr<Stage> makeStage(const char *arg, unsigned fs, size_t channels)
+{
+	std::vector<std::string> p = split(arg);
+	const std::string &type = p[0];
+	const float toRad = 2.0F * (float)M_PI / (float)fs;
+
+	if(type == "gain" && p.size() == 2)
+	{
+		return std::unique_ptr<Stage>(new GainStage((float)atof(p[1].c_str())));
+	}
+	if(type == "fir" && (p.size() == 2 || p.size() == 3))
+	{
+		std::vector<float> h;
+		if(!dsp::loadCoefArray(p[1].c_str(), p.size() == 3 ? p[2].c_str() : nullptr, h)) return nullptr;
+		return std::unique_ptr<Stage>(new FirStage(h, channels));
+	}
+	if(type == "iir" && p.size() == 2)
+	{
+		std::vector<float> b, a;
+		std::string text;
+		if(!dsp::readTextFile(p[1].c_str(), text) || !dsp::parseCoefArray(text, "b_coefs", b)
+				|| !dsp::parseCoefArray(text, "a_coefs", a)) return nullptr;
+		return std::unique_ptr<Stage>(new IirStage(dsp::tfToSos(b.data(), b.size(), a.data(), a.size()), channels));
+	}
+	if(type == "butter" || type == "cheby1")
+	{
+		// Prewarped, so the edges land exactly on the requested Hz
+		const size_t first = type == "cheby1" ? 4 : 3;
+		if(p.size() < first + 1) return nullptr;
+		dsp::IirDesignSpec is = {dsp::IIR_LOWPASS, dsp::IIR_BUTTERWORTH, atoi(p[2].c_str()), 0.0F, 0.0F, 0.0F, true};
+		if(type == "cheby1")
+		{
+			is.family = dsp::IIR_CHEBYSHEV1;
+			is.rippleDb = (float)atof(p[3].c_str());
+		}
+		if(p[1] == "hp") is.type = dsp::IIR_HIGHPASS;
+		else if(p[1] == "bp") is.type = dsp::IIR_BANDPASS;
+		else if(p[1] == "bs") is.type = dsp::IIR_BANDSTOP;
+		else if(p[1] != "lp") return nullptr;
+		const bool band = is.type == dsp::IIR_BANDPASS || is.type == dsp::IIR_BANDSTOP;
+		if(p.size() != first + (band ? 2 : 1)) return nullptr;
+		is.w1 = (float)atof(p[first].c_str()) * toRad;
+		if(band) is.w2 = (float)atof(p[first + 1].c_str()) * toRad;
+		std::vector<dsp::Biquad> sos;
+		if(!dsp::iirDesign(is, sos)) return nullptr;
+		return std::unique_ptr<Stage>(new IirStage(sos, channels));
+	}
+
+	dsp::FirDesignSpec spec = {dsp::FIR_LOWPASS, 0.0F, 0.0F, 0, dsp::FIR_WIN_HAMMING, 0.0F};
+	if((type == "lp" || type == "hp") && p.size() == 3)
+	{
+		spec.type = type == "lp" ? dsp::FIR_LOWPASS : dsp::FIR_HIGHPASS;
+		spec.w1 = (float)atof(p[1].c_str()) * toRad;
+		spec.numTaps = atoi(p[2].c_str());
+	}
+	else if((type == "bp" || type == "bs") && p.size() == 4)
+	{
+		spec.type = type == "bp" ? dsp::FIR_BANDPASS : dsp::FIR_BANDSTOP;
+		spec.w1 = (float)atof(p[1].c_str()) * toRad;
+		spec.w2 = (float)atof(p[2].c_str()) * toRad;
+		spec.numTaps = atoi(p[3].c_str());
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	std::vector<float> h(spec.numTaps > 0 ? spec.numTaps : 0);
+	if(!dsp::firDesign(spec, h.data())) return nullptr;
+	return std::unique_ptr<Stage>(new FirStage(h, channels));
+}
+
+/* Main ----------------------------------------------------------------------*/
+int main(int argc, char **argv)
+{
+	size_t chunk = DEFAULT_CHUNK_FRAMES;
+	unsigned outBits = 16;
+	int i = 1;
+	for(; i < argc && argv[i][0] == '-'; i++)
+	{
+		if(!strcmp(argv[i], "-b") && i + 1 < argc) chunk = (size_t)atol(argv[++i]);
+		else if(!strcmp(argv[i], "-f")) outBits = 32;
+		else { usage(); return 1; }
+	}
+	if(argc - i < 3 || !chunk)
+	{
+		usage();
+		return 1;
+	}
+	const char *inPath = argv[i++];
+	const char *outPath = argv[i++];
+
+	dsp::WavReader in;
+	if(!in.open(inPath))
+	{
+		fprintf(stderr, "Cannot read %s (PCM 8/16/24/32 or float 32 WAV expected)\n", inPath);
+		return 1;
+	}
+	const size_t C = in.channels();
+
+	std::vector<std::unique_ptr<Stage>> chain;
+	size_t latency = 0;
+	for(; i < argc; i++)
+	{
+		std::unique_ptr<Stage> s = makeStage(argv[i], in.sampleRate(), C);
+		if(!s)
+		{
+			fprintf(stderr, "Invalid stage '%s'\n", argv[i]);
+			return 1;
+		}
+		latency += s->latency();
+		chain.push_back(std::move(s));
+	}
+
+	dsp::WavWriter out;
+	if(!out.open(outPath, (unsigned)C, in.sampleRate(), outBits))
+	{
+		fprintf(stderr, "Cannot write %s\n", outPath);
+		return 1;
+	}
+
+	// Bounded working set: one interleaved chunk plus one planar copy.
+	// The stages are linear and time invariant, so their block delays add up:
+	// skip that many output frames, then push as many zero frames at the end.
+	std::vector<float> frames(chunk * C), planar(chunk * C);
+	size_t skip = latency, flush = latency;
+	double tProc = 0.0;
+	auto t0 = std::chrono::steady_clock::now();
+	for(;;)
+	{
+		size_t n = in.read(frames.data(), chunk);
+		if(!n)
+		{
+			if(!flush) break;
+			n = flush < chunk ? flush : chunk;
+			std::fill(frames.begin(), frames.begin() + n * C, 0.0F);
+			flush -= n;
+		}
+		auto p0 = std::chrono::steady_clock::now();
+		for(size_t c = 0; c < C; c++)
+		{
+			float *x = &planar[c * chunk];
+			for(size_t k = 0; k < n; k++) x[k] = frames[k * C + c];
+			for(auto &s : chain) s->process(c, x, n);
+			for(size_t k = 0; k < n; k++) frames[k * C + c] = x[k];
+		}
+		tProc += std::chrono::duration<double>(std::chrono::steady_clock::now() - p0).count();
+
+		const size_t drop = skip < n ? skip : n;
+		skip -= drop;
+		if(n > drop && !out.write(&frames[drop * C], n - drop))
+		{
+			fprintf(stderr, "Write error on %s\n", outPath);
+			return 1;
+		}
+	}
+	if(!out.close())
+	{
+		fprintf(stderr, "Cannot finish the header of %s\n", outPath);
+		return 1;
+	}
+	double tTotal = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+	const double samples = (double)out.frames() * (double)C;
+	printf("%s: %llu frames x %zu ch @ %u Hz, %zu stages\n", inPath,
+			(unsigned long long)out.frames(), C, in.sampleRate(), chain.size());
+	printf("filters %.3f s (%.1f Msamples/s) | end to end %.3f s (%.1f Msamples/s, %.1fx real time)\n",
+			tProc, samples / tProc / 1e6, tTotal, samples / tTotal / 1e6,
+			(double)out.frames() / in.sampleRate() / tTotal);
+	return 0;
+}
@@ -0,0 +1,288 @@
+/*
+ * wav.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: User123
+ *
+ *  Streaming WAV reader/writer for the host tools. Files are read and written
+ *  in fixed-size chunks of frames, so RAM use is bounded by the chunk size and
+ *  not by the file length. Samples are exchanged as interleaved floats in
+ *  [-1, 1). Reads PCM 8/16/24/32-bit and IEEE float 32-bit, writes PCM 16-bit
+ *  or float 32-bit. Sizes are patched into the header on close().
+ *  Files past the 4 GB RIFF limit are read and written as RF64 (EBU Tech
+ *  3306): the writer reserves a JUNK chunk for the ds64 sizes and turns the
+ *  file into RF64 on close() only if the data did not fit in 32 bits.
+ */
+
+#ifndef DSP_WAV_H_
+#define DSP_WAV_H_
+
+/* Exported Includes ----------------------------------------------------------*/
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+namespace dsp {
+
+/* Exported define ------------------------------------------------------------*/
+#define WAV_FORMAT_PCM		(1)
+#define WAV_FORMAT_FLOAT	(3)
+#define WAV_FORMAT_EXT		(0xFFFE)
+#define WAV_DS64_SIZE		(28)	// ds64 chunk without a table: RIFF, data and sample count sizes
+#define WAV_HEADER_SIZE		(12 + 8 + WAV_DS64_SIZE + 8 + 16 + 8)
+
+/* Exported function prototypes -----------------------------------------------*/
+inline uint32_t wavLe32(const uint8_t *p) { return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24); }
+inline uint16_t wavLe16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+inline uint64_t wavLe64(const uint8_t *p) { return wavLe32(p) | (uint64_t)wavLe32(p + 4) << 32; }
+
+inline void wavPut32(uint8_t *p, uint32_t v) { p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24; }
+inline void wavPut16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+inline void wavPut64(uint8_t *p, uint64_t v) { wavPut32(p, (uint32_t)v); wavPut32(p + 4, (uint32_t)(v >> 32)); }
+
+/* Exported class -------------------------------------------------------------*/
+class WavReader
+{
+public:
+	~WavReader() { close(); }
+
+	// Parses the RIFF header up to the start of the data chunk
+	bool open(const char *path)
+	{
+		close();
+		fp_ = fopen(path, "rb");
+		if(!fp_) return false;
+
+		uint8_t hdr[12];
+		if(fread(hdr, 1, 12, fp_) != 12 || (memcmp(hdr, "RIFF", 4) && memcmp(hdr, "RF64", 4))
+				|| memcmp(hdr + 8, "WAVE", 4)) return fail();
+
+		bool haveFmt = false;
+		uint64_t ds64Data = 0;
+		uint8_t ck[8];
+		while(fread(ck, 1, 8, fp_) == 8)
+		{
+			uint32_t size = wavLe32(ck + 4);
+			if(!memcmp(ck, "ds64", 4))
+			{
+				// RF64: the real data size, the data chunk says 0xFFFFFFFF
+				uint8_t ds[WAV_DS64_SIZE];
+				if(size < WAV_DS64_SIZE || fread(ds, 1, WAV_DS64_SIZE, fp_) != WAV_DS64_SIZE) return fail();
+				ds64Data = wavLe64(ds + 8);
+				fseek(fp_, (long)(size - WAV_DS64_SIZE + (size & 1)), SEEK_CUR);
+			}
+			else if(!memcmp(ck, "fmt ", 4))
+			{
+				uint8_t fmt[40] = {0};
+				size_t n = size < sizeof(fmt) ? size : sizeof(fmt);
+				if(fread(fmt, 1, n, fp_) != n) return fail();
+				if(size > n) fseek(fp_, size - n, SEEK_CUR);
+				format_ = wavLe16(fmt);
+				channels_ = wavLe16(fmt + 2);
+				sampleRate_ = wavLe32(fmt + 4);
+				bits_ = wavLe16(fmt + 14);
+				// WAVE_FORMAT_EXTENSIBLE keeps the real format in the sub-format GUID
+				if(format_ == WAV_FORMAT_EXT && size >= 26) format_ = wavLe16(fmt + 24);
+				haveFmt = true;
+			}
+			else if(!memcmp(ck, "data", 4))
+			{
+				if(!haveFmt || !channels_) return fail();
+				bytesPerFrame_ = channels_ * (bits_ / 8);
+				if(!bytesPerFrame_) return fail();
+				frames_ = (size == 0xFFFFFFFFU && ds64Data ? ds64Data : size) / bytesPerFrame_;
+				remaining_ = frames_;
+				return supported() ? true : fail();
+			}
+			else
+			{
+				fseek(fp_, size + (size & 1), SEEK_CUR);
+			}
+		}
+		return fail();
+	}
+
+	/*
+	 * Reads up to maxFrames frames as interleaved floats into x (at least
+	 * maxFrames*channels() entries). Returns the frames read, 0 at the end.
+	 */
+	size_t read(float *x, size_t maxFrames)
+	{
+		size_t n = maxFrames < remaining_ ? maxFrames : (size_t)remaining_;
+		if(!fp_ || !n) return 0;
+
+		raw_.resize(n * bytesPerFrame_);
+		n = fread(raw_.data(), bytesPerFrame_, n, fp_);
+		remaining_ -= n;
+
+		const size_t count = n * channels_;
+		const uint8_t *p = raw_.data();
+		for(size_t i = 0; i < count; i++)
+		{
+			switch(bits_)
+			{
+			case 8: x[i] = ((float)p[i] - 128.0F) / 128.0F; break;
+			case 16: x[i] = (float)(int16_t)wavLe16(p + 2 * i) / 32768.0F; break;
+			case 24:
+			{
+				int32_t v = (int32_t)(p[3*i] << 8 | p[3*i + 1] << 16 | (uint32_t)p[3*i + 2] << 24) >> 8;
+				x[i] = (float)v / 8388608.0F;
+				break;
+			}
+			default:
+			{
+				uint32_t v = wavLe32(p + 4 * i);
+				if(format_ == WAV_FORMAT_FLOAT)
+				{
+					memcpy(&x[i], &v, sizeof(float));
+				}
+				else
+				{
+					x[i] = (float)((double)(int32_t)v / 2147483648.0);
+				}
+				break;
+			}
+			}
+		}
+		return n;
+	}
+
+	void close()
+	{
+		if(fp_) fclose(fp_);
+		fp_ = nullptr;
+	}
+
+	unsigned channels() const { return channels_; }
+	unsigned sampleRate() const { return sampleRate_; }
+	unsigned bitsPerSample() const { return bits_; }
+	uint64_t frames() const { return frames_; }
+
+private:
+	bool supported() const
+	{
+		if(format_ == WAV_FORMAT_FLOAT) return bits_ == 32;
+		return format_ == WAV_FORMAT_PCM && (bits_ == 8 || bits_ == 16 || bits_ == 24 || bits_ == 32);
+	}
+
+	bool fail()
+	{
+		close();
+		return false;
+	}
+
+	FILE *fp_ = nullptr;
+	unsigned format_ = 0, channels_ = 0, sampleRate_ = 0, bits_ = 0;
+	size_t bytesPerFrame_ = 0;
+	uint64_t frames_ = 0, remaining_ = 0;
+	std::vector<uint8_t> raw_;		// One chunk of file bytes
+};
+
+class WavWriter
+{
+public:
+	~WavWriter() { close(); }
+
+	// bits = 16 writes PCM (clipped like toInt16), bits = 32 writes float
+	bool open(const char *path, unsigned channels, unsigned sampleRate, unsigned bits = 16)
+	{
+		close();
+		if(bits != 16 && bits != 32) return false;
+		fp_ = fopen(path, "wb");
+		if(!fp_) return false;
+		channels_ = channels;
+		sampleRate_ = sampleRate;
+		bits_ = bits;
+		frames_ = 0;
+		writeHeader();
+		return true;
+	}
+
+	// Appends frames interleaved frames from x
+	bool write(const float *x, size_t frames)
+	{
+		if(!fp_ || !channels_) return false;
+		const size_t count = frames * channels_;
+		raw_.resize(count * (bits_ / 8));
+		uint8_t *p = raw_.data();
+		for(size_t i = 0; i < count; i++)
+		{
+			if(bits_ == 16)
+			{
+				float v = x[i] > 1.0F ? 1.0F : (x[i] < -1.0F ? -1.0F : x[i]);
+				float s = v * 32768.0F;
+				wavPut16(p + 2 * i, (uint16_t)(int16_t)(s > 32767.0F ? 32767.0F : s));
+			}
+			else
+			{
+				uint32_t v;
+				memcpy(&v, &x[i], sizeof(float));
+				wavPut32(p + 4 * i, v);
+			}
+		}
+		frames_ += frames;
+		return fwrite(p, 1, raw_.size(), fp_) == raw_.size();
+	}
+
+	// Patches the RIFF and data sizes (RF64 past 4 GB) and closes the file.
+	// False if the header or the buffered data could not be written.
+	bool close()
+	{
+		if(!fp_) return true;
+		bool ok = fseek(fp_, 0, SEEK_SET) == 0 && writeHeader();
+		ok = fclose(fp_) == 0 && ok;
+		fp_ = nullptr;
+		return ok;
+	}
+
+	uint64_t frames() const { return frames_; }
+
+private:
+	/*
+	 * RIFF, a JUNK chunk the size of ds64, fmt and the data chunk header. The
+	 * sizes no longer fit in 32 bits past 4 GB: the JUNK chunk becomes ds64
+	 * with the 64-bit sizes, RIFF becomes RF64 and the 32-bit fields are set
+	 * to 0xFFFFFFFF.
+	 */
+	bool writeHeader()
+	{
+		uint8_t h[WAV_HEADER_SIZE] = {0};
+		const uint32_t blockAlign = channels_ * (bits_ / 8);
+		const uint64_t dataSize = frames_ * blockAlign;
+		const uint64_t riffSize = WAV_HEADER_SIZE - 8 + dataSize;
+		const bool rf64 = riffSize > 0xFFFFFFFFULL;
+		memcpy(h, rf64 ? "RF64" : "RIFF", 4);
+		wavPut32(h + 4, rf64 ? 0xFFFFFFFFU : (uint32_t)riffSize);
+		memcpy(h + 8, "WAVE", 4);
+		memcpy(h + 12, rf64 ? "ds64" : "JUNK", 4);
+		wavPut32(h + 16, WAV_DS64_SIZE);
+		if(rf64)
+		{
+			wavPut64(h + 20, riffSize);
+			wavPut64(h + 28, dataSize);
+			wavPut64(h + 36, frames_);
+		}
+		uint8_t *f = h + 20 + WAV_DS64_SIZE;
+		memcpy(f, "fmt ", 4);
+		wavPut32(f + 4, 16);
+		wavPut16(f + 8, bits_ == 32 ? WAV_FORMAT_FLOAT : WAV_FORMAT_PCM);
+		wavPut16(f + 10, (uint16_t)channels_);
+		wavPut32(f + 12, sampleRate_);
+		wavPut32(f + 16, sampleRate_ * blockAlign);
+		wavPut16(f + 20, (uint16_t)blockAlign);
+		wavPut16(f + 22, (uint16_t)bits_);
+		memcpy(f + 24, "data", 4);
+		wavPut32(f + 28, rf64 ? 0xFFFFFFFFU : (uint32_t)dataSize);
+		return fwrite(h, 1, sizeof(h), fp_) == sizeof(h);
+	}
+
+	FILE *fp_ = nullptr;
+	unsigned channels_ = 0, sampleRate_ = 0, bits_ = 16;
+	uint64_t frames_ = 0;
+	std::vector<uint8_t> raw_;
+};
+
+} // namespace dsp
+
+#endif /* DSP_WAV_H_ */
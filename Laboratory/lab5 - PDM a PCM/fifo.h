@@ -3,6 +3,9 @@
  *
  *  Created on: Mar 12, 2025
  *      Author: User123
+ *
+ *  Not safe between an ISR and the main loop: numel is read-modify-written
+ *  by both sides. The audio path uses dsp/spsc_ring.h instead.
  */
 
 #ifndef INC_FIFO_H_
@@ -16,8 +19,8 @@ typedef struct
 {
 	int16_t *buffer;	// Wr/Rd PCM FIFO buffer in half-words
 	uint16_t capacity;
-	uint8_t wr_idx;		// FIFO write pointer
-	uint8_t rd_idx;		// FIFO read pointer
+	uint16_t wr_idx;	// FIFO write pointer
+	uint16_t rd_idx;	// FIFO read pointer
 	uint16_t numel;		// FIFO element count
 } Fifo_t;
 
@@ -27,8 +27,12 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
-#include "fifo.h"
 #include "cs43l22.h"
+#include "../dsp/iir_q31.h"
+#include "../dsp/spsc_ring.h"
+#include "../dsp/pdm_decim.h"
+#include "../dsp/dma_event_queue.h"
+#include "../dsp/asrc.h"
 #include <stdio.h>
 /* USER CODE END Includes */
 
@@ -52,15 +56,30 @@
 #define AUDIO_PDM_BUFFER_SIZE	(AUDIO_NUM_OUT_SAMPLES*AUDIO_NUM_IN_CHANNELS*AUDIO_DECIMATION_FACTOR/16)
 #define AUDIO_PCM_BUFFER_SIZE	(AUDIO_NUM_OUT_SAMPLES*AUDIO_NUM_OUT_CHANNELS*AUDIO_FRAME_SIZE/16)
 
+// 1: open decimator (../dsp/pdm_decim.h), 0: ST's PDM_Filter library
+#define AUDIO_PDM_IN_TREE		(1)
+#define AUDIO_PDM_CIC_ORDER		(5)
+#define AUDIO_PDM_GAIN_DB		(24.0F)	// Same as the PDM2PCM mic_gain in the .ioc
+#define AUDIO_PDM_FRONT_END		PDM_DEC_FE_LUT8	// 5 KB table; PDM_DEC_FE_LUT4: 640 B, more cycles
+
 // Audio DMA Buffers
 #define AUDIO_RX_DMA_BUFSIZE	(2*AUDIO_PDM_BUFFER_SIZE)
 #define AUDIO_TX_DMA_BUFSIZE	(2*AUDIO_PCM_BUFFER_SIZE)
 
-// Internal Flags
-#define AUDIO_RX_HALFCPLT_STATE	(1)
-#define AUDIO_RX_FULLCPLT_STATE	(2)
-#define AUDIO_TX_HALFCPLT_STATE (1)
-#define AUDIO_TX_FULLCPLT_STATE	(2)
+// PCM FIFO between the microphone and the DAC: power of two, at least twice the TX DMA buffer
+#define AUDIO_PCM_FIFO_SIZE		(512UL)
+
+// DMA event sources (mAudioEvents)
+#define AUDIO_EVT_RX			(0)	// I2S2, microphone
+#define AUDIO_EVT_TX			(1)	// I2S3, CS43L22
+
+// Clock drift between the microphone and the DAC (../dsp/asrc.h): FIFO level held, loop bandwidth
+#define AUDIO_ASRC_TARGET		(3*AUDIO_NUM_OUT_SAMPLES)	// Latency: 3 ms
+#define AUDIO_ASRC_LOOP_HZ		(0.1F)
+
+// Microphone DC blocker (2nd order Butterworth high-pass)
+#define AUDIO_HPF_NUM_STAGES	(1)
+#define AUDIO_HPF_OUT_SHIFT		(2)		// b is stored divided by 4, the 4 comes back at the output
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -74,9 +93,23 @@
 uint16_t uAudioRxDmaBuffer[AUDIO_RX_DMA_BUFSIZE];
 int16_t uAudioTxDmaBuffer[AUDIO_TX_DMA_BUFSIZE];
 int16_t uPcmBuffer[AUDIO_NUM_OUT_SAMPLES];
-volatile uint8_t ucAudioRxDmaState = 0;	// Flag for RX DMA buffer full status
-volatile uint8_t ucAudioTxDmaState = 0;	// Flag for TX DMA buffer full status
+DmaEventQueue_t mAudioEvents;	// DMA half/full events from the ISRs, in order
+Asrc_t mAsrc;	// Microphone clock to DAC clock, see bench/bench_asrc.cpp
+volatile uint32_t uAudioRxStamp;	// DWT->CYCCNT at the last RX half/full event
 int16_t uPcmValue = 0;
+
+// 20 Hz high-pass at 48 kHz, {b0, b1, b2, a1, a2} per stage (a0 = 1). b is
+// divided by 2^AUDIO_HPF_OUT_SHIFT so that sum|c| ~ 3.99 < 4: the Q31
+// accumulator cannot overflow for any input (see iir_q31.h)
+const float fHpfSos[AUDIO_HPF_NUM_STAGES*BIQUAD_Q31_COEFS] = {0.24953762779761295976F, -0.49907525559522591952F, 0.24953762779761295976F, -1.99629760176912185443F, 0.99630444299268561270F};
+int32_t iHpfCoefs[AUDIO_HPF_NUM_STAGES*BIQUAD_Q31_COEFS];	// fHpfSos in Q2.30
+int32_t iHpfState[AUDIO_HPF_NUM_STAGES*BIQUAD_Q31_STATE];
+BiquadQ31_t mHpf;	// Q31 biquad with error feedback, bit-exact with bench/bench_iir_q31.cpp
+
+#if AUDIO_PDM_IN_TREE
+PdmDecimator_t mPdmDec;	// CIC tables and FIR taps built at startup, see bench/bench_pdm_decim.cpp
+int32_t iPdmTable[PDM_DEC_TABLE_WORDS(AUDIO_PDM_FRONT_END, AUDIO_DECIMATION_FACTOR, AUDIO_PDM_CIC_ORDER)];
+#endif
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -102,6 +135,9 @@ int _write(int file, char *ptr, int len)
  */
 void AudioProcessCallback(int16_t *micData, uint16_t numSamples)
 {
+	// Remove the microphone DC offset and sub-audio rumble, in place
+	BIQUAD_Q31_Process(&mHpf, micData, micData, numSamples, 1, 1);
+
 	for(int n = 0; n < numSamples; n++)
 	{
 		uPcmValue = micData[n];
@@ -111,7 +147,85 @@ void AudioProcessCallback(int16_t *micData, uint16_t numSamples)
 
 /* Private user code ---------------------------------------------------------*/
 /* USER CODE BEGIN 0 */
+/*
+ * Converts one PDM DMA half to PCM straight into the FIFO (no copy) when the
+ * free room is contiguous. Only when it wraps around the end of the FIFO (2
+ * blocks in 32) or is too short does the block go through uPcmBuffer.
+ */
+static void AudioRxToFifo(uint16_t *pPdm, SpscRing_t *pFifo)
+{
+  SpscSpan_t span;
+  SPSC_Reserve(pFifo, AUDIO_NUM_OUT_SAMPLES, &span);
+  int16_t *pPcm = (span.len[0] == AUDIO_NUM_OUT_SAMPLES) ? span.data[0] : &uPcmBuffer[0];
+
+  // Convert the PDM DMA half to PCM
+#if AUDIO_PDM_IN_TREE
+  PDM_DEC_Process(&mPdmDec, pPdm, pPcm, AUDIO_NUM_OUT_SAMPLES);
+#else
+  PDM_Filter(pPdm, pPcm, &PDM1_filter_handler);
+#endif
+
+  /* Data can be processed here */
+  AudioProcessCallback(pPcm, AUDIO_NUM_OUT_SAMPLES);
+  /* -------------------------- */
+
+  // Hand it to the TX side
+  if(pPcm == span.data[0]) SPSC_Commit(pFifo, AUDIO_NUM_OUT_SAMPLES);
+  else SPSC_WriteBlock(pFifo, pPcm, AUDIO_NUM_OUT_SAMPLES);
+}
 
+/*
+ * Microphone samples captured but not in the FIFO yet: the RX events still
+ * queued, plus the part of the RX half being filled, from the cycle counter
+ * since its last event (the DMA counter only moves by half a sample, which
+ * the drift sweeps through the ASRC loop). Retries if an RX event comes in
+ * between the two reads.
+ */
+static float AudioRxPending(const DmaEventQueue_t *pEvents)
+{
+  uint32_t uPosted, uStamp;
+  do
+  {
+    uPosted = __atomic_load_n(&pEvents->posted[AUDIO_EVT_RX], __ATOMIC_ACQUIRE);
+    uStamp = uAudioRxStamp;
+  } while(uPosted != __atomic_load_n(&pEvents->posted[AUDIO_EVT_RX], __ATOMIC_ACQUIRE));
+  if(uPosted == 0) return 0.0F;
+
+  float fPart = (float)(DWT->CYCCNT - uStamp) * ((float)AUDIO_SAMPLE_RATE / (float)SystemCoreClock);
+  fPart = fPart > AUDIO_NUM_OUT_SAMPLES ? AUDIO_NUM_OUT_SAMPLES : fPart;
+  return (float)((uPosted - pEvents->expected[AUDIO_EVT_RX]) * AUDIO_NUM_OUT_SAMPLES) + fPart;
+}
+
+/*
+ * Fills one TX DMA half (AUDIO_PCM_BUFFER_SIZE words) through the ASRC, each
+ * sample to both channels. The ASRC reads from the FIFO at the microphone's
+ * rate and holds the level at AUDIO_ASRC_TARGET; silence until the level
+ * first gets there. Runs in the window until the DMA comes back to this half.
+ */
+static void AudioFifoToTx(SpscRing_t *pFifo, int16_t *pHalf)
+{
+  int16_t uMono[AUDIO_PCM_BUFFER_SIZE / AUDIO_NUM_OUT_CHANNELS];
+  ASRC_Update(&mAsrc, (float)SPSC_Count(pFifo) + AudioRxPending(&mAudioEvents));
+  ASRC_Process(&mAsrc, pFifo, uMono, AUDIO_PCM_BUFFER_SIZE / AUDIO_NUM_OUT_CHANNELS);
+  SPSC_DupStereo(uMono, pHalf, AUDIO_PCM_BUFFER_SIZE / AUDIO_NUM_OUT_CHANNELS);
+}
+
+/*
+ * Reports (ITM) every DMA half that was missed (event queue full) or handled
+ * after the DMA had come back to it, and every ASRC output made without input.
+ */
+static void AudioCheckOverruns(const DmaEventQueue_t *pEvents)
+{
+  static uint32_t uOverruns = 0;
+  if(DMA_EVQ_Overruns(pEvents) + mAsrc.underruns != uOverruns)
+  {
+    uOverruns = DMA_EVQ_Overruns(pEvents) + mAsrc.underruns;
+    printf("Audio overrun: RX missed %lu late %lu, TX missed %lu late %lu, ASRC underruns %lu\n",
+           (unsigned long)pEvents->missed[AUDIO_EVT_RX], (unsigned long)pEvents->late[AUDIO_EVT_RX],
+           (unsigned long)pEvents->missed[AUDIO_EVT_TX], (unsigned long)pEvents->late[AUDIO_EVT_TX],
+           (unsigned long)mAsrc.underruns);
+  }
+}
 /* USER CODE END 0 */
 
 /**
@@ -168,10 +282,38 @@ int main(void)
   HAL_CS43L22_Set_Volume(50);
   HAL_CS43L22_Start();
 
+  // Flush-to-zero for any float DSP (the M4 FPU has no subnormal penalty,
+  // FZ just keeps host and board results alike)
+  DSP_EnableFlushToZero();
+
+#if AUDIO_PDM_IN_TREE
+  // PDM decimator init
+  const PdmDecConfig_t mPdmCfg = {AUDIO_DECIMATION_FACTOR, AUDIO_PDM_CIC_ORDER, AUDIO_PDM_GAIN_DB, AUDIO_PDM_FRONT_END};
+  PDM_DEC_Init(&mPdmDec, &mPdmCfg, iPdmTable);
+#endif
+
+  // Microphone high-pass init, every section must be overflow-free
+  BIQUAD_Q31_Quantize(fHpfSos, iHpfCoefs, AUDIO_HPF_NUM_STAGES);
+  if(BIQUAD_Q31_Init(&mHpf, iHpfCoefs, iHpfState, AUDIO_HPF_NUM_STAGES) != 0)
+  {
+    Error_Handler();
+  }
+  mHpf.outShift = AUDIO_HPF_OUT_SHIFT;
+
   // PCM Fifo init
-  int16_t PcmFifoBuffer[AUDIO_TX_DMA_BUFSIZE*2]; // At least twice the TX DMA buffer size
-  Fifo_t mPcmFifo;
-  FIFO_Init(&mPcmFifo, PcmFifoBuffer, AUDIO_TX_DMA_BUFSIZE*2);
+  int16_t PcmFifoBuffer[AUDIO_PCM_FIFO_SIZE];
+  SpscRing_t mPcmFifo;	// Lock-free: the producer or the consumer may move to an ISR
+  SPSC_Init(&mPcmFifo, PcmFifoBuffer, AUDIO_PCM_FIFO_SIZE);
+
+  // DMA event queue init; keep the debugger (and ITM) connected while the core sleeps in WFI
+  DMA_EVQ_Init(&mAudioEvents);
+  HAL_DBGMCU_EnableDBGSleepMode();
+
+  // ASRC init (one update per 1 ms TX half) and the cycle counter for the RX event time stamps
+  ASRC_Init(&mAsrc, AUDIO_ASRC_TARGET, AUDIO_ASRC_LOOP_HZ, AUDIO_NUM_OUT_SAMPLES, 1000.0F);
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 
   // Start I2S audio transmission(DAC)/reception(Mic) DMA service
   HAL_I2S_Transmit_DMA(&hi2s3, (uint16_t*) uAudioTxDmaBuffer, AUDIO_TX_DMA_BUFSIZE / (AUDIO_FRAME_SIZE/16UL));
@@ -182,79 +324,29 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
-	  // IMP34DT05 PDM Microphone --------------------------------------------------
-	  if(ucAudioRxDmaState == AUDIO_RX_HALFCPLT_STATE)
+	  // Handle the DMA events in the order they happened
+	  DmaEvent_t mEvent;
+	  while(DMA_EVQ_Pop(&mAudioEvents, &mEvent))
 	  {
-		  // Clear the flag
-		  ucAudioRxDmaState = 0;
-
-		  // Convert the first half PDM DMA buffer to PCM
-		  PDM_Filter(&uAudioRxDmaBuffer[0], &uPcmBuffer[0], &PDM1_filter_handler);
-
-		  /* Data can be processed here */
-		  AudioProcessCallback(uPcmBuffer, AUDIO_NUM_OUT_SAMPLES);
-		  /* -------------------------- */
-
-		  // Store into a FIFO for transmission
-		  FIFO_WriteBlock(&mPcmFifo, uPcmBuffer, AUDIO_NUM_OUT_SAMPLES);
-	  }
-	  if(ucAudioRxDmaState == AUDIO_RX_FULLCPLT_STATE)
-	  {
-		  // Clear the flag
-		  ucAudioRxDmaState = 0;
-
-		  // Convert the second half PDM DMA buffer to PCM
-		  PDM_Filter(&uAudioRxDmaBuffer[AUDIO_PDM_BUFFER_SIZE], &uPcmBuffer[0], &PDM1_filter_handler);
-
-		  /* Data can be processed here -------------------------------*/
-		  AudioProcessCallback(uPcmBuffer, AUDIO_NUM_OUT_SAMPLES);
-		  /* --------------------------------------------------------- */
-
-		  // Store into a FIFO for transmission
-		  FIFO_WriteBlock(&mPcmFifo, uPcmBuffer, AUDIO_NUM_OUT_SAMPLES);
-	  }
-
-	  // CS43L22 DAC Codec --------------------------------------------
-	  if(ucAudioTxDmaState == AUDIO_TX_HALFCPLT_STATE)
-	  {
-		  // Clear the flag
-		  ucAudioTxDmaState = 0;
-
-		  // Check if there is at least a full PCM output buffer
-		  if(mPcmFifo.numel >= AUDIO_PCM_BUFFER_SIZE)
+		  if(mEvent.source == AUDIO_EVT_RX)
 		  {
-			  for (int i = 0; i < AUDIO_PCM_BUFFER_SIZE; i=i+(2*AUDIO_FRAME_SIZE/16))
-			  {
-				// Read data from the FIFO
-				int16_t value = 0;
-				FIFO_Read(&mPcmFifo, &value);
-
-				// Duplicate output channel for stereo sound
-				uAudioTxDmaBuffer[i] = value;							// Right channel
-				uAudioTxDmaBuffer[i + (AUDIO_FRAME_SIZE/16)] = value;	// Left channel
-			 }
+			  // IMP34DT05 PDM Microphone: the finished PDM DMA half to PCM, into the FIFO for transmission
+			  AudioRxToFifo(&uAudioRxDmaBuffer[mEvent.half * AUDIO_PDM_BUFFER_SIZE], &mPcmFifo);
 		  }
-	  }
-	  if(ucAudioTxDmaState == AUDIO_TX_FULLCPLT_STATE)
-	  {
-		  // Clear the flag
-		  ucAudioTxDmaState = 0;
-
-		  // Check if there is at least a full PCM output buffer
-		  if(mPcmFifo.numel >= AUDIO_PCM_BUFFER_SIZE)
+		  else
 		  {
-			  for (int i=AUDIO_PCM_BUFFER_SIZE; i < 2*AUDIO_PCM_BUFFER_SIZE; i=i+(2*AUDIO_FRAME_SIZE/16))
-			  {
-				  // Read data from the FIFO
-				  int16_t value = 0;
-				  FIFO_Read(&mPcmFifo, &value);
-
-				  // Duplicate output channel for stereo sound
-				  uAudioTxDmaBuffer[i] = value;							// Right channel
-				  uAudioTxDmaBuffer[i + (AUDIO_FRAME_SIZE/16)] = value;	// Left channel
-			  }
+			  // CS43L22 DAC Codec: refill the TX DMA half that was just sent
+			  AudioFifoToTx(&mPcmFifo, &uAudioTxDmaBuffer[mEvent.half * AUDIO_PCM_BUFFER_SIZE]);
 		  }
 	  }
+	  AudioCheckOverruns(&mAudioEvents);
+
+	  // Sleep until the next interrupt. Masked, an interrupt still ends WFI (its
+	  // handler runs after __enable_irq()), so an event posted after the check
+	  // is not slept through.
+	  __disable_irq();
+	  if(DMA_EVQ_Empty(&mAudioEvents)) __WFI();
+	  __enable_irq();
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -332,14 +424,16 @@ void HAL_I2S_RxHalfCpltCallback (I2S_HandleTypeDef *hi2s)
 {
 	// The first half DMA buffer was filled and is ready to process
 	// The second half DMA buffer is currently filling
-	ucAudioRxDmaState = AUDIO_RX_HALFCPLT_STATE;
+	uAudioRxStamp = DWT->CYCCNT;
+	DMA_EVQ_Post(&mAudioEvents, AUDIO_EVT_RX, 0);
 }
 
 void HAL_I2S_RxCpltCallback (I2S_HandleTypeDef *hi2s)
 {
 	// The second half dma buffer was filled and is ready to process
 	// The first half DMA buffer is currently filling
-	ucAudioRxDmaState = AUDIO_RX_FULLCPLT_STATE;
+	uAudioRxStamp = DWT->CYCCNT;
+	DMA_EVQ_Post(&mAudioEvents, AUDIO_EVT_RX, 1);
 }
 
 // CS43L22 DMA Interrupts ==============================================
@@ -347,14 +441,14 @@ void HAL_I2S_TxHalfCpltCallback (I2S_HandleTypeDef *hi2s)
 {
 	// The first half DMA buffer is available for writing
 	// The second half DMA buffer is currently transmitting
-	ucAudioTxDmaState = AUDIO_TX_HALFCPLT_STATE;
+	DMA_EVQ_Post(&mAudioEvents, AUDIO_EVT_TX, 0);
 }
 
 void HAL_I2S_TxCpltCallback (I2S_HandleTypeDef *hi2s)
 {
 	// The second half DMA buffer is available for writing
 	// The first half DMA buffer is currently transmitting
-	ucAudioTxDmaState = AUDIO_TX_FULLCPLT_STATE;
+	DMA_EVQ_Post(&mAudioEvents, AUDIO_EVT_TX, 1);
 }
 /* USER CODE END 4 */
 
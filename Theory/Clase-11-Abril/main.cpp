@@ -1,6 +1,8 @@
 /* Private Includes --------------------------*/
 #include <Arduino.h>
 #include "AudioKitHAL.h"
+#include "../../Laboratory/dsp/fir_static.h"
+#include "../../Laboratory/dsp/fir_design.h"
 
 /* Private Defines ---------------------------*/
 #define DMA_BUFFER_SIZE (32)	/*<! The number of samples to read/write */
@@ -8,53 +10,34 @@
 #define FIR_NUM_TAPS 	(11)	/*<! The number of coefficients of the filter */
 
 /* Private Funcions ---------------------------*/
-int FIR_LowPass_Calc(float wc, int M,float *h)
+// Runtime designs (e.g. after a cutoff change), rectangular window as in class.
+// High-pass and band-stop only allow odd filter taps.
+int FIR_LowPass_Calc(float wc, int M, float *h)
 {
-	// Only allows for even filter taps
-	if( (M % 2) == 0) return 0;
-	
-	for(int k = 0; k < M; k++)
-	{
-		if(k == ((M-1)/2))
-		{
-			h[k] = wc/M_PI;
-		}
-		else
-		{
-			h[k] = wc/M_PI * sin(wc*(k - (M - 1)/2))/(wc*(k - (M - 1)/2));
-		}
-	}
-	
-	return 1;
+	return dsp::firDesign({dsp::FIR_LOWPASS, wc, 0.0F, M, dsp::FIR_WIN_RECTANGULAR, 0.0F}, h);
 }
 
 int FIR_HighPass_Calc(float wc, int M, float *h)
 {
-	// Only allows for even filter taps
-	if( (M % 2) == 0) return 0;
-	
-	return 1;
+	return dsp::firDesign({dsp::FIR_HIGHPASS, wc, 0.0F, M, dsp::FIR_WIN_RECTANGULAR, 0.0F}, h);
 }
 
 int FIR_BandPass_Calc(float w1, float w2, int M, float *h)
 {
-	// Only allows for even filter taps
-	if( (M % 2) == 0) return 0;
-	
-	return 1;
+	return dsp::firDesign({dsp::FIR_BANDPASS, w1, w2, M, dsp::FIR_WIN_RECTANGULAR, 0.0F}, h);
 }
 
 int FIR_StopBand_Calc(float w1, float w2, int M, float *h)
 {
-	// Only allows for even filter taps
-	if( (M % 2) == 0) return 0;
-	
-	return 1;
+	return dsp::firDesign({dsp::FIR_BANDSTOP, w1, w2, M, dsp::FIR_WIN_RECTANGULAR, 0.0F}, h);
 }
 
 /* Global variables ---------------------------*/
-int16_t xprev[FIR_NUM_TAPS-1];	// h[n-1], h[n-2], ..., h[n-(TAPS-1)]
-float hlp[FIR_NUM_TAPS];	// Low-pass filter impulse response buffer
+int16_t AudioBuffer[DMA_BUFFER_SIZE];	//!< Buffer that stores the data to process
+AudioKit kit;
+// Low-pass filter impulse response (Fc = 500Hz), designed by the compiler
+constexpr auto hlp = dsp::firLowPassConst<FIR_NUM_TAPS>(2*DSP_PI*500/SAMPLE_RATE);
+dsp::Fir<FIR_NUM_TAPS, hlp> fir;	// Fully unrolled FIR, filters a whole frame per call
 
 /* Setup --------------------------------------*/
 void setup()
@@ -62,17 +45,6 @@ void setup()
 	// Init serial
 	Serial.begin(115200);
 	
-	// Fir filter begin
-	float wc = 2*M_PI*500/SAMPLE_RATE;	// Fc = 500Hz
-	if( !FIR_LowPass_Calc(wc, FIR_NUM_TAPS, hlp) ) 
-	{
-		Serial.println("Invalid Number of taps");
-		while(1)
-		{
-			
-		}
-	}
-	
 	// I2S Config
 	auto cfg = kit.defaultConfig(KitInputOutput);
 	cfg.adc_input = AUDIO_HAL_ADC_INPUT_LINE2;		// MICROPHONE/AUXIN audio input
@@ -94,26 +66,9 @@ void loop()
 
 	/* DSP processing goes here */
 	// "AudioBuffer" variable has both Left and Right audio samples
-	// n+=2 ensures we take only the Left audio samples
-	for(int n = 0; n < bytesRead/2; n+=2) {
-		// y[n] = x[n]*h[0] + x[n-1]*h[1] + .... + x[n - M + 1]*h[M-1]
-		float y = h[0]*AudioBuffer[n];
-		for(k = 0; k < 10; k++)
-		{
-			y += xprev[k]*h[k+1];
-		}
-		
-		// Update previous input buffer
-		for(k = 10; k > 0; k--)
-		{
-			xprev[k] = xprev[k-1];
-		}
-		xprev[0] = AudioBuffer[n];
-		
-		// Set current sample (Both L&R samples)
-		AudioBuffer[n] = (int16_t)y;
-		AudioBuffer[n+1] = (int16_t)y;
-	}
+	// The whole frame is filtered in one call: the Left samples are filtered
+	// and written back to both channels
+	fir.processAudioBuffer(AudioBuffer, bytesRead/2);
 	// DSP END
 
 	/* Signal Reconstruction (write to DAC) */